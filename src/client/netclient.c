@@ -61,6 +61,11 @@ static ang_file *fp = NULL;
 static bool dump_only = false;
 
 
+/* Compressed stream: raw data from the socket and its decompressor */
+static sockbuf_t zbuf;
+static struct net_inflate *inflater;
+
+
 /* Packet types */
 static int cur_type = 0;
 static int prev_type = 0;
@@ -1848,7 +1853,7 @@ static int rle_decode(sockbuf_t* buf, cave_view_type* lineref, int max_col, int
     for (x = 0; x < max_col; x++)
     {
         /* Read the char/attr pair */
-        nread = Packet_scanf(buf, "%c%hu", &c, &a);
+        nread = Packet_get_cell(buf, &c, &a);
         if (nread <= 0)
         {
             /* Rollback the socket buffer */
@@ -1866,7 +1871,7 @@ static int rle_decode(sockbuf_t* buf, cave_view_type* lineref, int max_col, int
             a &= ~(0x8000);
 
             /* Read the number of repetitions */
-            nread = Packet_scanf(buf, "%hu", &n);
+            nread = Packet_get_run_length(buf, &n);
             if (nread <= 0)
             {
                 /* Rollback the socket buffer */
@@ -1885,7 +1890,7 @@ static int rle_decode(sockbuf_t* buf, cave_view_type* lineref, int max_col, int
             a &= ~(0x40);
 
             /* Read the number of repetitions */
-            nread = Packet_scanf(buf, "%hu", &n);
+            nread = Packet_get_run_length(buf, &n);
             if (nread <= 0)
             {
                 /* Rollback the socket buffer */
@@ -2002,7 +2007,7 @@ static int Receive_line_info(void)
     int bytes_read;
 
     /* Read line number */
-    if ((n = Packet_scanf(&rbuf, "%b%hd%hd", &ch, &y, &cols)) <= 0) return n;
+    if ((n = Packet_get_line_info(&rbuf, &ch, &y, &cols)) <= 0) return n;
     bytes_read = 5;
 
     /* Defaults */
@@ -2212,19 +2217,70 @@ static int Receive_show_floor(void)
 }
 
 
+/*
+ * Draw a grid of the main map (or queue it for later if the map is hidden)
+ */
+static void draw_map_char(byte ch, byte x, byte y, u16b a, char c, u16b tap, char tcp)
+{
+    byte x_off;
+    bool draw = true;
+
+    player->scr_info[y][x].a = a;
+    player->scr_info[y][x].c = c;
+
+    if (use_graphics)
+    {
+        player->trn_info[y][x].a = tap;
+        player->trn_info[y][x].c = tcp;
+    }
+
+    /* Hack -- manipulate offset */
+    x_off = x + COL_MAP;
+
+    if (player->screen_save_depth || section_icky_row || store_ctx) draw = false;
+    if (section_icky_row)
+    {
+        if (y >= section_icky_row) draw = true;
+        else if ((section_icky_col > 0) && (x_off >= section_icky_col)) draw = true;
+        else if ((section_icky_col < 0) && (x_off >= 0 - section_icky_col)) draw = true;
+    }
+
+    if (draw)
+    {
+        x_off += x * (tile_width - 1);
+        y = (y - 1) * tile_height + 1;
+
+        Term_queue_char_safe(x_off, y, a, c, tap, tcp);
+        if (tile_width * tile_height > 1)
+        {
+            u16b a_dummy = (use_graphics? COLOUR_WHITE: 0);
+            char c_dummy = (use_graphics? ' ': 0);
+
+            Term_big_queue_char_safe(x_off, y, a, c, a_dummy, c_dummy);
+        }
+    }
+
+    /* Queue for later */
+    else
+    {
+        if ((Packet_put_char(&qbuf, ch, x, y, a, c) > 0) && use_graphics)
+            Packet_put_tile(&qbuf, tap, tcp);
+    }
+}
+
+
 static int Receive_char(void)
 {
     int n;
     byte ch;
-    byte x, y, x_off;
+    byte x, y;
     char c, tcp;
     u16b a, tap;
-    bool draw = true;
     int bytes_read;
 
     tap = tcp = c = a = x = y = 0;
 
-    if ((n = Packet_scanf(&rbuf, "%b%b%b%hu%c", &ch, &x, &y, &a, &c)) <= 0)
+    if ((n = Packet_get_char(&rbuf, &ch, &x, &y, &a, &c)) <= 0)
         return n;
     bytes_read = 6;
 
@@ -2244,12 +2300,9 @@ static int Receive_char(void)
         return 1;
     }
 
-    player->scr_info[y][x].a = a;
-    player->scr_info[y][x].c = c;
-
     if (use_graphics)
     {
-        if ((n = Packet_scanf(&rbuf, "%hu%c", &tap, &tcp)) <= 0)
+        if ((n = Packet_get_tile(&rbuf, &tap, &tcp)) <= 0)
         {
             /* Rollback the socket buffer */
             Sockbuf_rollback(&rbuf, bytes_read);
@@ -2258,46 +2311,44 @@ static int Receive_char(void)
             return n;
         }
         bytes_read += 3;
-
-        player->trn_info[y][x].a = tap;
-        player->trn_info[y][x].c = tcp;
     }
 
-    /* Hack -- manipulate offset */
-    x_off = x + COL_MAP;
+    draw_map_char(ch, x, y, a, c, tap, tcp);
 
-    if (player->screen_save_depth || section_icky_row || store_ctx) draw = false;
-    if (section_icky_row)
-    {
-        if (y >= section_icky_row) draw = true;
-        else if ((section_icky_col > 0) && (x_off >= section_icky_col)) draw = true;
-        else if ((section_icky_col < 0) && (x_off >= 0 - section_icky_col)) draw = true;
-    }
+    return 1;
+}
 
-    if (draw)
-    {
-        x_off += x * (tile_width - 1);
-        y = (y - 1) * tile_height + 1;
 
-        Term_queue_char_safe(x_off, y, a, c, tap, tcp);
-        if (tile_width * tile_height > 1)
-        {
-            u16b a_dummy = (use_graphics? COLOUR_WHITE: 0);
-            char c_dummy = (use_graphics? ' ': 0);
+/*
+ * Horizontal run of grids of the main map
+ */
+static int Receive_char_run(void)
+{
+    int n, i;
+    byte ch, x, y, len;
+    cave_view_type run[256], trn[256];
+    int bytes_read;
 
-            Term_big_queue_char_safe(x_off, y, a, c, a_dummy, c_dummy);
-        }
-    }
+    if ((n = Packet_get_char_run(&rbuf, &ch, &x, &y, &len)) <= 0)
+        return n;
+    bytes_read = 4;
 
-    /* Queue for later */
-    else
+    /* Decode the secondary attr/char stream */
+    memset(trn, 0, sizeof(trn));
+    if (use_graphics)
     {
-        n = Packet_printf(&qbuf, "%b%b%b%hu%c", (unsigned)ch, (unsigned)x,
-            (unsigned)y, (unsigned)a, (int)c);
-        if ((n > 0) && use_graphics)
-            Packet_printf(&qbuf, "%hu%c", (unsigned)tap, (int)tcp);
+        n = rle_decode(&rbuf, trn, len, RLE_LARGE, &bytes_read);
+        if (n <= 0) return n;
     }
 
+    /* Decode the attr/char stream */
+    n = rle_decode(&rbuf, run, len, DUNGEON_RLE_MODE(), &bytes_read);
+    if (n <= 0) return n;
+
+    /* Draw the grids (as single grids if they have to be queued) */
+    for (i = 0; i < len; i++)
+        draw_map_char(PKT_CHAR, x + i, y, run[i].a, run[i].c, trn[i].a, trn[i].c);
+
     return 1;
 }
 
@@ -4220,7 +4271,7 @@ int Send_breath(struct command *cmd)
     if (cmd_get_target(cmd, "direction", &dir) != CMD_OK)
         return 0;
 
-    if ((n = Packet_printf(&wbuf, "%b%c", (unsigned)PKT_BREATH, dir)) <= 0)
+    if ((n = Packet_put_dir(&wbuf, PKT_BREATH, dir)) <= 0)
         return n;
 
     return 1;
@@ -4235,7 +4286,7 @@ int Send_walk(struct command *cmd)
     if (cmd_get_target(cmd, "direction", &dir) != CMD_OK)
         return 0;
 
-    if ((n = Packet_printf(&wbuf, "%b%c", (unsigned)PKT_WALK, dir)) <= 0)
+    if ((n = Packet_put_dir(&wbuf, PKT_WALK, dir)) <= 0)
         return n;
 
     return 1;
@@ -4250,7 +4301,7 @@ int Send_run(struct command *cmd)
     if (cmd_get_target(cmd, "direction", &dir) != CMD_OK)
         return 0;
 
-    if ((n = Packet_printf(&wbuf, "%b%c", (unsigned)PKT_RUN, dir)) <= 0)
+    if ((n = Packet_put_dir(&wbuf, PKT_RUN, dir)) <= 0)
         return n;
 
     return 1;
@@ -4439,7 +4490,7 @@ int Send_open(struct command *cmd)
     if (cmd_get_target(cmd, "direction", &dir) != CMD_OK)
         return 0;
 
-    if ((n = Packet_printf(&wbuf, "%b%c", (unsigned)PKT_OPEN, dir)) <= 0)
+    if ((n = Packet_put_dir(&wbuf, PKT_OPEN, dir)) <= 0)
         return n;
 
     return 1;
@@ -4817,7 +4868,7 @@ int Send_disarm(struct command *cmd)
     if (cmd_get_target(cmd, "direction", &dir) != CMD_OK)
         return 0;
 
-    if ((n = Packet_printf(&wbuf, "%b%c", (unsigned)PKT_DISARM, dir)) <= 0)
+    if ((n = Packet_put_dir(&wbuf, PKT_DISARM, dir)) <= 0)
         return n;
 
     return 1;
@@ -4875,7 +4926,7 @@ int Send_locate(int dir)
 {
     int n;
 
-    if ((n = Packet_printf(&wbuf, "%b%c", (unsigned)PKT_LOCATE, dir)) <= 0)
+    if ((n = Packet_put_dir(&wbuf, PKT_LOCATE, dir)) <= 0)
         return n;
 
     return 1;
@@ -4930,7 +4981,7 @@ int Send_close(struct command *cmd)
     if (cmd_get_target(cmd, "direction", &dir) != CMD_OK)
         return 0;
 
-    if ((n = Packet_printf(&wbuf, "%b%c", (unsigned)PKT_CLOSE, dir)) <= 0)
+    if ((n = Packet_put_dir(&wbuf, PKT_CLOSE, dir)) <= 0)
         return n;
 
     return 1;
@@ -5060,7 +5111,7 @@ int Send_steal(struct command *cmd)
     if (cmd_get_target(cmd, "direction", &dir) != CMD_OK)
         return 0;
 
-    if ((n = Packet_printf(&wbuf, "%b%c", (unsigned)PKT_STEAL, dir)) <= 0)
+    if ((n = Packet_put_dir(&wbuf, PKT_STEAL, dir)) <= 0)
         return n;
 
     return 1;
@@ -5144,7 +5195,7 @@ int Send_alter(struct command *cmd)
     if (cmd_get_target(cmd, "direction", &dir) != CMD_OK)
         return 0;
 
-    if ((n = Packet_printf(&wbuf, "%b%c", (unsigned)PKT_ALTER, dir)) <= 0)
+    if ((n = Packet_put_dir(&wbuf, PKT_ALTER, dir)) <= 0)
         return n;
 
     return 1;
@@ -5171,7 +5222,7 @@ int Send_jump(struct command *cmd)
     if (cmd_get_target(cmd, "direction", &dir) != CMD_OK)
         return 0;
 
-    if ((n = Packet_printf(&wbuf, "%b%c", (unsigned)PKT_JUMP, dir)) <= 0)
+    if ((n = Packet_put_dir(&wbuf, PKT_JUMP, dir)) <= 0)
         return n;
 
     return 1;
@@ -5846,8 +5897,10 @@ int Net_packet(void)
  * 1) wbuf is used only for sending packets (write/printf).
  * 2) rbuf is used for receiving packets in (read/scanf).
  * 3) qbuf is the queue buffer.
+ * If the server compresses the stream, the data read from the socket goes to zbuf first and
+ * is decompressed from there into rbuf.
  */
-int Net_init(int fd)
+int Net_init(int fd, byte caps)
 {
     int sock;
 
@@ -5887,6 +5940,18 @@ int Net_init(int fd)
         return -1;
     }
 
+    /* Compressed stream: rbuf is now filled from zbuf */
+    if (caps & NET_CAP_DEFLATE)
+    {
+        if (Sockbuf_init(&zbuf, sock, CLIENT_RECV_SIZE, SOCKBUF_READ | SOCKBUF_WRITE) == -1)
+        {
+            plog_fmt("No memory for compressed read buffer (%u)", CLIENT_RECV_SIZE);
+            return -1;
+        }
+        inflater = net_inflate_new();
+        rbuf.state |= SOCKBUF_LOCK;
+    }
+
     /* Initialized */
     initialized = 1;
 
@@ -5922,6 +5987,13 @@ void Net_cleanup(void)
     Sockbuf_cleanup(&rbuf);
     Sockbuf_cleanup(&wbuf);
     Sockbuf_cleanup(&qbuf);
+    if (inflater)
+    {
+        Sockbuf_cleanup(&zbuf);
+        net_inflate_free(inflater);
+        inflater = NULL;
+    }
+    net_compress_cleanup();
 
     /*
      * Make sure that we won't try to write to the socket again,
@@ -5960,6 +6032,36 @@ int Net_fd(void)
 }
 
 
+/*
+ * Decompress the data read from the socket and process the packets, a buffer at a time.
+ */
+static int Net_inflate(void)
+{
+    int n;
+
+    do
+    {
+        n = net_inflate(inflater, &zbuf, &rbuf);
+        if (n == -1)
+        {
+            errno = 0;
+            plog("Corrupted compressed stream");
+            return -1;
+        }
+        if (Net_packet() == -1) return -1;
+
+        /* Make room for more packets */
+        Sockbuf_advance(&rbuf, rbuf.ptr - rbuf.buf);
+    }
+    while (n > 0);
+
+    /* Make room for more data */
+    Sockbuf_advance(&zbuf, zbuf.ptr - zbuf.buf);
+
+    return 0;
+}
+
+
 /*
  * Read packets from the net until there are no more available.
  */
@@ -5973,6 +6075,16 @@ int Net_input(void)
     /* Keep reading as long as we have something on the socket */
     while (SocketReadable(netfd))
     {
+        /* Compressed stream */
+        if (inflater)
+        {
+            n = Sockbuf_read(&zbuf);
+            if (n == 0) quit("Server closed the connection");
+            else if (n < 0) return n;
+            else if (Net_inflate() == -1) return -1;
+            continue;
+        }
+
         n = Sockbuf_read(&rbuf);
         if (n == 0) quit("Server closed the connection");
         else if (n < 0) return n;
@@ -114,7 +114,7 @@ extern int cmd_project(struct command *cmd);
 
 /*** General network functions ***/
 extern int Net_packet(void);
-extern int Net_init(int fd);
+extern int Net_init(int fd, byte caps);
 extern void Net_cleanup(void);
 extern int Net_flush(void);
 extern int Net_fd(void);
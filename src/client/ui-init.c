@@ -376,6 +376,7 @@ void client_init(void)
     DWORD nSize = NORMAL_WID;
     bool done = false;
     u16b num, max;
+    byte caps = 0;
     u32b num_name;
     size_t i, j;
     struct keypress c;
@@ -491,6 +492,7 @@ void client_init(void)
     Packet_printf(&ibuf, "%hu", (unsigned)conntype);
     Packet_printf(&ibuf, "%hu%c", (unsigned)current_version(), (int)beta_version());
     Packet_printf(&ibuf, "%s%s%s%s", real_name, host_name, nick, stored_pass);
+    Packet_printf(&ibuf, "%b", (unsigned)NET_CAP_DEFLATE);
 
     /* Send it */
     if (!Net_Send(Socket, &ibuf))
@@ -564,8 +566,11 @@ void client_init(void)
         }
     }
 
+    /* Capabilities agreed on by the server (older servers don't send them) */
+    if (ibuf.ptr < ibuf.buf + ibuf.len) Packet_scanf(&ibuf, "%b", &caps);
+
     /* Server agreed to talk, initialize the buffers */
-    if (Net_init(Socket) == -1)
+    if (Net_init(Socket, caps) == -1)
         quit("Network initialization failed!");
 
     /* Get character name and pass */
@@ -43,6 +43,7 @@
 #include "display.h"
 #include "guid.h"
 #include "md5.h"
+#include "net-compress.h"
 #include "obj-common.h"
 #include "obj-gear-common.h"
 #include "obj-tval.h"
@@ -6,6 +6,8 @@
 #ifndef INCLUDED_DISPLAY_H
 #define INCLUDED_DISPLAY_H
 
+struct player;
+
 extern s16b cfg_fps;
 
 /*** Display hooks ***/
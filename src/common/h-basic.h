@@ -14,16 +14,41 @@
  * Note: I build PWMAngband with C++ Builder, which DOES NOT have stdbool
  */
 
+/*
+ * Extract the "WINDOWS" flag from the compiler
+ */
+#if defined(_WIN32) || defined(WIN32) || defined(__WIN32__)
+# ifndef WINDOWS
+#  define WINDOWS
+# endif
+#endif
+
+/*
+ * Everything else is assumed to be a POSIX system (headless Linux server)
+ */
+#ifndef WINDOWS
+# ifndef UNIX
+#  define UNIX
+# endif
+#endif
+
 /*
  * Every system seems to use its own symbol as a path separator.
  */
 #undef PATH_SEP
 #undef PATH_SEPC
-#define PATH_SEP "\\"
-#define PATH_SEPC '\\'
+#ifdef WINDOWS
+# define PATH_SEP "\\"
+# define PATH_SEPC '\\'
+#else
+# define PATH_SEP "/"
+# define PATH_SEPC '/'
+#endif
 
-#define EWOULDBLOCK WSAEWOULDBLOCK
-#define ECONNRESET WSAECONNRESET
+#ifdef WINDOWS
+# define EWOULDBLOCK WSAEWOULDBLOCK
+# define ECONNRESET WSAECONNRESET
+#endif
 
 /*
  * Include the library header files
@@ -46,12 +71,14 @@
 
 /** Other headers **/
 
-#include <io.h>
+#ifdef WINDOWS
+# include <io.h>
+#else
+# include <unistd.h>
+# include <stddef.h>
+#endif
 #include <fcntl.h>
 
-/* Basic networking stuff */
-#include "h-net.h"
-
 /*
  * Define the basic game types
  */
@@ -98,6 +125,9 @@ typedef struct
     u32b turn;
 } hturn;
 
+/* Basic networking stuff (uses the types above) */
+#include "h-net.h"
+
 /*
  * Basic math macros
  */
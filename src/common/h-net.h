@@ -7,7 +7,11 @@
 #include "sockbuf.h"
 
 /* Include the socket library for the correct OS */
+#ifdef WINDOWS
 #include "net-win.h"
+#else
+#include "net-unix.h"
+#endif
 
 /* Include the various packet types and error codes */
 #include "pack.h"
@@ -0,0 +1,48 @@
+/*
+ * File: list-packet-layouts.h
+ * Purpose: Fixed layouts of the most frequent packets
+ */
+
+/*
+ * name
+ * type and name of each field, in the order they are sent
+ *
+ * Field types are those of Packet_printf() and Packet_scanf(): b (byte), c (char),
+ * hd (s16b), hu (u16b), ld (s32b) and lu (u32b). Strings can't be used, since their
+ * size isn't fixed. Field names must not clash with the locals of the generated
+ * functions (sbuf, pkt_buf, pkt_ptr, pkt_n).
+ *
+ * Each layout gives a Packet_put_<name>() and a Packet_get_<name>() function, which
+ * behave like Packet_printf() and Packet_scanf() with the equivalent format string,
+ * but with a single bounds check per packet.
+ */
+
+/* Packet type alone (PKT_END...) */
+PKT_LAYOUT1(type, b, type)
+
+/* Packet type and direction (PKT_WALK, PKT_RUN...) */
+PKT_LAYOUT2(dir, b, type, c, dir)
+
+/* Header of PKT_LINE_INFO and PKT_MINI_MAP */
+PKT_LAYOUT3(line_info, b, type, hd, y, hd, cols)
+
+/* Single grid of a RLE-encoded line */
+PKT_LAYOUT2(cell, c, c, hu, a)
+
+/* Run of identical grids of a RLE-encoded line */
+PKT_LAYOUT3(cell_run, c, c, hu, a, hu, n)
+
+/* Number of repetitions of the last grid of a RLE-encoded line */
+PKT_LAYOUT1(run_length, hu, n)
+
+/* PKT_CHAR */
+PKT_LAYOUT5(char, b, type, b, x, b, y, hu, a, c, c)
+
+/* PKT_CHAR with the transparency attr/char (graphics mode) */
+PKT_LAYOUT7(char_tile, b, type, b, x, b, y, hu, a, c, c, hu, ta, c, tc)
+
+/* Header of PKT_CHAR_RUN */
+PKT_LAYOUT4(char_run, b, type, b, x, b, y, b, n)
+
+/* Transparency attr/char of PKT_CHAR */
+PKT_LAYOUT2(tile, hu, a, c, c)
@@ -158,3 +158,4 @@ PKT(FLUSH, undefined, flush, undefined, flush)
 PKT(CHANNEL, undefined, channel, undefined, channel)
 PKT(HISTORY, undefined, history, undefined, history)
 PKT(AUTOINSCR, autoinscriptions, undefined, undefined, autoinscriptions)
+PKT(CHAR_RUN, undefined, undefined, undefined, char_run)
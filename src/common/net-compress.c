@@ -0,0 +1,290 @@
+/*
+ * File: net-compress.c
+ * Purpose: Optional compression of the server to client stream
+ *
+ * Copyright (c) 2019 MAngband and PWMAngband Developers
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+
+#include "angband.h"
+
+/* Use our own allocators */
+#define SDL_malloc(X)       mem_alloc(X)
+#define SDL_free(X)         mem_free(X)
+#define SDL_realloc(X, Y)   mem_realloc((X), (Y))
+
+/* The bundled miniz trips -Wmisleading-indentation: keep our build warning-free */
+#if defined(__GNUC__) && (__GNUC__ >= 6)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmisleading-indentation"
+#endif
+#include "../fix/miniz.h"
+#if defined(__GNUC__) && (__GNUC__ >= 6)
+#pragma GCC diagnostic pop
+#endif
+
+
+/*
+ * When both sides support it, everything the server sends after the login is cut into
+ * frames, one per flush of the reliable buffer. Each frame starts with a header giving
+ * its type and length:
+ *   - FRAME_RAW: the data follows as is
+ *   - FRAME_DEFLATE: the data follows as a piece of a single raw deflate stream
+ *
+ * The deflate stream lives as long as the connection and each frame ends with a sync
+ * flush, so the client can decode a frame as soon as it has received it, while later
+ * frames can still refer to anything sent before (the last 32KB).
+ */
+
+
+/* Search depth for each compression level (same as zlib levels) */
+static const mz_uint net_probes[10] = {0, 1, 6, 32, 16, 32, 128, 256, 512, 768};
+
+
+struct net_deflate
+{
+    tdefl_compressor comp;
+};
+
+
+struct net_inflate
+{
+    tinfl_decompressor inf;
+    mz_uint8 dict[TINFL_LZ_DICT_SIZE];  /* Sliding window (also the output buffer) */
+    size_t dict_ofs;                    /* Start of the pending output in the window */
+    size_t dict_avail;                  /* Pending output */
+    bool more;                          /* The decompressor has more output */
+    int type;                           /* Type of the current frame */
+    u32b left;                          /* Bytes left to read in the current frame */
+};
+
+
+/* Scratch space for the frames */
+static char *frame_buf;
+static size_t frame_size;
+
+
+struct net_deflate *net_deflate_new(int level)
+{
+    struct net_deflate *z = mem_zalloc(sizeof(*z));
+    mz_uint flags;
+
+    level = MAX(MIN(level, 9), 1);
+    flags = net_probes[level];
+    if (level <= 3) flags |= TDEFL_GREEDY_PARSING_FLAG;
+
+    if (tdefl_init(&z->comp, NULL, NULL, (int)flags) != TDEFL_STATUS_OKAY)
+    {
+        mem_free(z);
+        return NULL;
+    }
+
+    return z;
+}
+
+
+void net_deflate_free(struct net_deflate *z)
+{
+    mem_free(z);
+}
+
+
+/*
+ * Write a frame header
+ */
+void net_frame_header(char *buf, int type, int len)
+{
+    buf[0] = (char)type;
+    buf[1] = (char)(len >> 24);
+    buf[2] = (char)(len >> 16);
+    buf[3] = (char)(len >> 8);
+    buf[4] = (char)len;
+}
+
+
+/*
+ * Add a frame with the deflated data to a socket buffer
+ *
+ * Returns the number of bytes added, or -1 on error.
+ */
+int net_deflate(struct net_deflate *z, sockbuf_t *out, const char *buf, int len)
+{
+    size_t need = FRAME_HEADER + FRAME_OVERHEAD + len + len / 8;
+    size_t in_bytes = len, out_bytes;
+    tdefl_status status;
+
+    /* Make room */
+    if (frame_size < need)
+    {
+        frame_buf = mem_realloc(frame_buf, need);
+        frame_size = need;
+    }
+
+    /* Deflate and flush everything */
+    out_bytes = frame_size - FRAME_HEADER;
+    status = tdefl_compress(&z->comp, buf, &in_bytes, frame_buf + FRAME_HEADER, &out_bytes,
+        TDEFL_SYNC_FLUSH);
+    if ((status != TDEFL_STATUS_OKAY) || (in_bytes != (size_t)len) ||
+        z->comp.m_output_flush_remaining)
+    {
+        errno = 0;
+        plog_fmt("Cannot deflate frame (%d, %d)", (int)status, len);
+        return -1;
+    }
+
+    net_frame_header(frame_buf, FRAME_DEFLATE, (int)out_bytes);
+    if (Sockbuf_write(out, frame_buf, FRAME_HEADER + (int)out_bytes) !=
+        FRAME_HEADER + (int)out_bytes)
+    {
+        return -1;
+    }
+
+    return FRAME_HEADER + (int)out_bytes;
+}
+
+
+/*
+ * Add a frame with the data as is to a socket buffer
+ *
+ * Returns the number of bytes added, or -1 on error.
+ */
+int net_raw(sockbuf_t *out, const char *buf, int len)
+{
+    size_t need = FRAME_HEADER + len;
+
+    /* Make room */
+    if (frame_size < need)
+    {
+        frame_buf = mem_realloc(frame_buf, need);
+        frame_size = need;
+    }
+
+    net_frame_header(frame_buf, FRAME_RAW, len);
+    memcpy(frame_buf + FRAME_HEADER, buf, len);
+    if (Sockbuf_write(out, frame_buf, FRAME_HEADER + len) != FRAME_HEADER + len) return -1;
+
+    return FRAME_HEADER + len;
+}
+
+
+struct net_inflate *net_inflate_new(void)
+{
+    struct net_inflate *z = mem_zalloc(sizeof(*z));
+
+    tinfl_init(&z->inf);
+
+    return z;
+}
+
+
+void net_inflate_free(struct net_inflate *z)
+{
+    mem_free(z);
+}
+
+
+/*
+ * Decode the frames received in "in" (from in->ptr) and append the data to "out", until
+ * either there is no more input or "out" is full. Partial frames are remembered, and
+ * the next call picks up where this one stopped.
+ *
+ * Returns the number of bytes added to "out", or -1 if the stream is corrupted.
+ */
+int net_inflate(struct net_inflate *z, sockbuf_t *in, sockbuf_t *out)
+{
+    int added = 0;
+
+    while (true)
+    {
+        size_t room = out->size - out->len;
+        size_t avail_in = in->buf + in->len - in->ptr;
+        size_t n;
+
+        /* Copy the pending output first */
+        if (z->dict_avail)
+        {
+            n = MIN(z->dict_avail, room);
+            if (!n) break;
+            memcpy(out->buf + out->len, z->dict + z->dict_ofs, n);
+            out->len += (int)n;
+            added += (int)n;
+            z->dict_ofs = (z->dict_ofs + n) & (TINFL_LZ_DICT_SIZE - 1);
+            z->dict_avail -= n;
+            continue;
+        }
+
+        /* Start a new frame */
+        if (!z->left && !z->more)
+        {
+            const byte *ptr = (const byte *)in->ptr;
+
+            if (avail_in < FRAME_HEADER) break;
+            z->type = ptr[0];
+            z->left = ((u32b)ptr[1] << 24) | ((u32b)ptr[2] << 16) | ((u32b)ptr[3] << 8) |
+                (u32b)ptr[4];
+            in->ptr += FRAME_HEADER;
+            if ((z->type != FRAME_RAW) && (z->type != FRAME_DEFLATE)) return -1;
+            continue;
+        }
+
+        avail_in = MIN(avail_in, z->left);
+
+        /* Raw data */
+        if (z->type == FRAME_RAW)
+        {
+            n = MIN(avail_in, room);
+            if (!n) break;
+            memcpy(out->buf + out->len, in->ptr, n);
+            out->len += (int)n;
+            added += (int)n;
+            in->ptr += n;
+            z->left -= (u32b)n;
+        }
+
+        /* Deflated data */
+        else
+        {
+            size_t in_bytes = avail_in;
+            size_t out_bytes = TINFL_LZ_DICT_SIZE - z->dict_ofs;
+            tinfl_status status;
+
+            if (!in_bytes && !z->more) break;
+
+            status = tinfl_decompress(&z->inf, (const mz_uint8 *)in->ptr, &in_bytes, z->dict,
+                z->dict + z->dict_ofs, &out_bytes, TINFL_FLAG_HAS_MORE_INPUT);
+            if (status < TINFL_STATUS_DONE) return -1;
+
+            in->ptr += in_bytes;
+            z->left -= (u32b)in_bytes;
+            z->dict_avail = out_bytes;
+            z->more = (status == TINFL_STATUS_HAS_MORE_OUTPUT);
+
+            /* No progress: wait for more input */
+            if (!in_bytes && !out_bytes) break;
+        }
+    }
+
+    return added;
+}
+
+
+/*
+ * Free the scratch space
+ */
+void net_compress_cleanup(void)
+{
+    mem_free(frame_buf);
+    frame_buf = NULL;
+    frame_size = 0;
+}
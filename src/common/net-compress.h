@@ -0,0 +1,35 @@
+/*
+ * File: net-compress.h
+ * Purpose: Optional compression of the server to client stream
+ */
+
+#ifndef INCLUDED_NET_COMPRESS_H
+#define INCLUDED_NET_COMPRESS_H
+
+/* Capabilities exchanged at login */
+#define NET_CAP_DEFLATE     0x01
+
+/* Frame types */
+#define FRAME_RAW           0
+#define FRAME_DEFLATE       1
+
+/* Size of a frame header: type (byte) and length (u32b) */
+#define FRAME_HEADER        5
+
+/* Largest overhead of a frame (header and worst case expansion of the deflated data) */
+#define FRAME_OVERHEAD      64
+
+struct net_deflate;
+struct net_inflate;
+
+extern struct net_deflate *net_deflate_new(int level);
+extern void net_deflate_free(struct net_deflate *z);
+extern int net_deflate(struct net_deflate *z, sockbuf_t *out, const char *buf, int len);
+extern int net_raw(sockbuf_t *out, const char *buf, int len);
+extern void net_frame_header(char *buf, int type, int len);
+extern struct net_inflate *net_inflate_new(void);
+extern void net_inflate_free(struct net_inflate *z);
+extern int net_inflate(struct net_inflate *z, sockbuf_t *in, sockbuf_t *out);
+extern void net_compress_cleanup(void);
+
+#endif /* INCLUDED_NET_COMPRESS_H */
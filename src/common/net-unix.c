@@ -0,0 +1,513 @@
+/*
+ * File: net-unix.c
+ * Purpose: Network module (POSIX port of net-win.c)
+ *
+ * Copyright (c) 2019 MAngband and PWMAngband Developers
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+#include "angband.h"
+
+/* _SOCKLIB_LIBSOURCE must be defined int this file */
+#define _SOCKLIB_LIBSOURCE
+
+/* Include files */
+#include <sys/time.h>
+#include <sys/select.h>
+
+/* Default timeout value of socklib_timeout */
+#define DEFAULT_S_TIMEOUT_VALUE     10
+#define DEFAULT_US_TIMEOUT_VALUE    0
+
+/* Global socklib errno variable */
+int sl_errno = 0;
+
+/* Global timeout variable. May be modified by users */
+int sl_timeout_s = DEFAULT_S_TIMEOUT_VALUE;
+int sl_timeout_us = DEFAULT_US_TIMEOUT_VALUE;
+
+/* Global variable containing the last address from DgramReceiveAny */
+struct sockaddr_in sl_dgram_lastaddr;
+
+/* Global broadcast enable variable (super-user only), default disabled */
+int sl_broadcast_enabled = 0;
+
+/* Static variable containing the last connection error */
+static int last_errno = 0;
+
+
+/*
+ * Sets the global timout value to s + us.
+ */
+void SetTimeout(int s, int us)
+{
+    sl_timeout_us = us;
+    sl_timeout_s = s;
+}
+
+
+/*
+ * Returns the port number of a socket connection.
+ */
+int GetPortNum(int fd)
+{
+    socklen_t len;
+    struct sockaddr_in addr;
+
+    len = sizeof(struct sockaddr_in);
+    if (getsockname(fd, (struct sockaddr *)&addr, &len) == -1)
+        return (-1);
+
+    return (ntohs(addr.sin_port));
+}
+
+
+/*
+ * Set the receive buffer size for either a stream or a datagram socket.
+ */
+int SetSocketReceiveBufferSize(int fd, int size)
+{
+    return (setsockopt(fd, SOL_SOCKET, SO_RCVBUF, (void *)&size, sizeof(size)));
+}
+
+
+/*
+ * Set the send buffer size for either a stream or a datagram socket.
+ */
+int SetSocketSendBufferSize(int fd, int size)
+{
+    return (setsockopt(fd, SOL_SOCKET, SO_SNDBUF, (void *)&size, sizeof(size)));
+}
+
+
+/*
+ * Set the nonblocking option on a socket.
+ */
+int SetSocketNonBlocking(int fd, int flag)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+
+    if (flags == -1) return (-1);
+    if (flag) flags |= O_NONBLOCK;
+    else flags &= ~O_NONBLOCK;
+    if (fcntl(fd, F_SETFL, flags) == -1)
+    {
+        perror("fcntl O_NONBLOCK failed in net-unix.c");
+        return (-1);
+    }
+
+    return 0;
+}
+
+
+/*
+ * Clear the error status for the socket and return the error in errno.
+ */
+int GetSocketError(int fd)
+{
+    int error;
+    socklen_t size;
+
+    size = sizeof(error);
+    if (getsockopt(fd, SOL_SOCKET, SO_ERROR, (void *)&error, &size) == -1)
+        return -1;
+    errno = error;
+    return 0;
+}
+
+
+/*
+ * Checks if data have arrived on the TCP/IP socket connection.
+ */
+int SocketReadable(int fd)
+{
+    fd_set readfds;
+    struct timeval timeout;
+
+    timeout.tv_sec = sl_timeout_s;
+    timeout.tv_usec = sl_timeout_us;
+
+    FD_ZERO(&readfds);
+    FD_SET(fd, &readfds);
+
+    if (select(fd + 1, &readfds, NULL, NULL, &timeout) == -1)
+        return ((errno == EINTR) ? 0 : -1);
+
+    if (FD_ISSET(fd, &readfds))
+        return (1);
+    return (0);
+}
+
+
+/*
+ * Performs a graceful shutdown and close on a TCP/IP socket.
+ */
+int SocketClose(int fd)
+{
+    /* whether there was an error or not, we close the socket */
+    shutdown(fd, SHUT_RDWR);
+
+    if (close(fd) == -1)
+        return (-1);
+    return (1);
+}
+
+
+/*
+ * Creates a UDP/IP datagram socket in the Internet domain.
+ */
+int CreateDgramSocket(int port)
+{
+    struct sockaddr_in addr_in;
+    int fd;
+    int retval;
+
+    fd = socket(AF_INET, SOCK_DGRAM, 0);
+    if (fd == -1)
+    {
+        sl_errno = SL_ESOCKET;
+        return (-1);
+    }
+
+    memset((char *)&addr_in, 0, sizeof(struct sockaddr_in));
+    addr_in.sin_family      = AF_INET;
+    addr_in.sin_addr.s_addr = INADDR_ANY;
+    addr_in.sin_port        = htons(port);
+    retval = bind(fd, (struct sockaddr *)&addr_in, sizeof(struct sockaddr_in));
+    if (retval == -1)
+    {
+        sl_errno = SL_EBIND;
+        retval = errno;
+        close(fd);
+        errno = retval;
+        return (-1);
+    }
+
+    return (fd);
+}
+
+
+/*
+ * Resolve a host name or dotted address.
+ */
+static bool resolve_host(const char *host, struct in_addr *addr)
+{
+    struct hostent *hp;
+
+    addr->s_addr = inet_addr(host);
+    if (addr->s_addr != (in_addr_t)-1) return true;
+
+    hp = gethostbyname(host);
+    if (hp == NULL)
+    {
+        sl_errno = SL_EHOSTNAME;
+        return false;
+    }
+    addr->s_addr = ((struct in_addr*)(hp->h_addr))->s_addr;
+
+    return true;
+}
+
+
+/*
+ * Transmits a UDP/IP datagram.
+ */
+int DgramSend(int fd, char *host, int port, char *sbuf, int size)
+{
+    struct sockaddr_in the_addr;
+
+    sl_errno = 0;
+    memset((char *)&the_addr, 0, sizeof(struct sockaddr_in));
+    the_addr.sin_family = AF_INET;
+    the_addr.sin_port = htons(port);
+    if (sl_broadcast_enabled)
+        the_addr.sin_addr.s_addr = INADDR_BROADCAST;
+    else if (!resolve_host(host, &the_addr.sin_addr))
+        return (-1);
+
+    return sendto(fd, sbuf, size, 0, (struct sockaddr *)&the_addr, sizeof(struct sockaddr_in));
+}
+
+
+/*
+ * Receives a datagram from any sender.
+ */
+int DgramReceiveAny(int fd, char *rbuf, int size)
+{
+    socklen_t addrlen = sizeof(struct sockaddr_in);
+
+    memset((char *)&sl_dgram_lastaddr, 0, addrlen);
+
+    return recvfrom(fd, rbuf, size, 0, (struct sockaddr *)&sl_dgram_lastaddr, &addrlen);
+}
+
+
+/*
+ * Transmits a UDP/IP datagram to the host/port the most recent datagram
+ * was received from.
+ */
+int DgramReply(int fd, char *sbuf, int size)
+{
+    return sendto(fd, sbuf, size, 0, (struct sockaddr *)&sl_dgram_lastaddr,
+        sizeof(struct sockaddr_in));
+}
+
+
+/*
+ * Receives a datagram on a connected datagram socket.
+ */
+int DgramRead(int fd, char *rbuf, int size)
+{
+    return recv(fd, rbuf, size, 0);
+}
+
+
+/*
+ * Sends a datagram on a connected datagram socket.
+ *
+ * MSG_NOSIGNAL: a peer that disconnected must not raise SIGPIPE.
+ */
+int DgramWrite(int fd, char *wbuf, int size)
+{
+    return send(fd, wbuf, size, MSG_NOSIGNAL);
+}
+
+
+/*
+ * Writes several buffers at once (at most DGRAM_IOV_MAX) on a connected socket.
+ */
+int DgramWriteV(int fd, char **bufs, int *sizes, int count)
+{
+    struct iovec iov[DGRAM_IOV_MAX];
+    struct msghdr msg;
+    int i;
+
+    if (count > DGRAM_IOV_MAX) count = DGRAM_IOV_MAX;
+    for (i = 0; i < count; i++)
+    {
+        iov[i].iov_base = bufs[i];
+        iov[i].iov_len = sizes[i];
+    }
+
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = count;
+
+    return sendmsg(fd, &msg, MSG_NOSIGNAL);
+}
+
+
+/*
+ * Extracts the last host name from the global variable sl_dgram_lastaddr.
+ */
+char *DgramLastname(void)
+{
+    struct hostent *he;
+    char *str;
+
+    he = gethostbyaddr((char *)&sl_dgram_lastaddr.sin_addr, sizeof(struct in_addr), AF_INET);
+    if (he == NULL)
+        str = inet_ntoa(sl_dgram_lastaddr.sin_addr);
+    else
+        str = (char *)he->h_name;
+    return str;
+}
+
+
+/*
+ * Performs a close on a UDP/IP datagram socket.
+ */
+void DgramClose(int fd)
+{
+    shutdown(fd, SHUT_RDWR);
+    close(fd);
+}
+
+
+/*
+ * Returns the Fully Qualified Domain Name for the local host.
+ */
+void GetLocalHostName(char *name, unsigned size)
+{
+    struct hostent *he;
+
+    gethostname(name, size);
+    if ((he = gethostbyname(name)) == NULL)
+        return;
+    my_strcpy(name, he->h_name, size);
+}
+
+
+/*
+ * Creates a TCP/IP server socket in the Internet domain.
+ *
+ * The function returns the socket descriptor, -2 if address is already in use,
+ * or -1 if any other error occured.
+ */
+int CreateServerSocket(int port)
+{
+    struct sockaddr_in addr_in;
+    int fd;
+    int retval;
+    int flag = 1;
+
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd == -1)
+    {
+        sl_errno = SL_ESOCKET;
+        return (-1);
+    }
+
+    /* Allow quick restarts while old connections are in TIME_WAIT */
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, (void *)&flag, sizeof(flag));
+
+    memset((char *)&addr_in, 0, sizeof(struct sockaddr_in));
+    addr_in.sin_family = AF_INET;
+    addr_in.sin_addr.s_addr = INADDR_ANY;
+    addr_in.sin_port = htons(port);
+
+    retval = bind(fd, (struct sockaddr *)&addr_in, sizeof(struct sockaddr_in));
+    if (retval == -1)
+    {
+        int error = errno;
+
+        sl_errno = SL_EBIND;
+        close(fd);
+
+        return ((error == EADDRINUSE)? -2: -1);
+    }
+
+    retval = listen(fd, 5);
+    if (retval == -1)
+    {
+        sl_errno = SL_ELISTEN;
+        close(fd);
+        return (-1);
+    }
+
+    return (fd);
+}
+
+
+/*
+ * Creates a TCP/IP client socket in the Internet domain.
+ */
+int CreateClientSocket(char *host, int port)
+{
+    struct sockaddr_in peer;
+    int fd;
+
+    last_errno = 0;
+
+    memset((char *)&peer, 0, sizeof(struct sockaddr_in));
+    peer.sin_family = AF_INET;
+    peer.sin_port = htons(port);
+    if (!resolve_host(host, &peer.sin_addr)) return (-1);
+
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd == -1)
+    {
+        sl_errno = SL_ESOCKET;
+        return (-1);
+    }
+
+    if (connect(fd, (struct sockaddr *)&peer, sizeof(struct sockaddr_in)) == -1)
+    {
+        last_errno = errno;
+        sl_errno = SL_ECONNECT;
+        close(fd);
+        return (-1);
+    }
+
+    return (fd);
+}
+
+
+/*
+ * This function is called in a TCP/IP server to accept incoming calls.
+ */
+int SocketAccept(int fd)
+{
+    return accept(fd, NULL, 0);
+}
+
+
+/*
+ * This function is called on a stream socket to set the linger option.
+ */
+int SocketLinger(int fd)
+{
+    static struct linger linger = {1, 300};
+
+    return setsockopt(fd, SOL_SOCKET, SO_LINGER, (void *)&linger, sizeof(struct linger));
+}
+
+
+/*
+ * Set the TCP_NODELAY option on a connected stream socket.
+ */
+int SetSocketNoDelay(int fd, int flag)
+{
+    return setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, (void *)&flag, sizeof(flag));
+}
+
+
+/*
+ * Receives <size> bytes and put them into buffer <buf> from socket <fd>.
+ */
+int SocketRead(int fd, char *buf, int size)
+{
+    int ret = 0, ret1;
+
+    while (ret < size)
+    {
+        ret1 = recv(fd, &buf[ret], size - ret, 0);
+        if (ret1 <= 0) return (ret);
+        ret += ret1;
+    }
+
+    return (ret);
+}
+
+
+const char *GetSocketErrorMessageAux(int error)
+{
+    switch (error)
+    {
+        case ENETDOWN: return "The network subsystem has failed...";
+        case EADDRINUSE: return "The specified address is already in use...";
+        case EINTR: return "The blocking call was canceled...";
+        case EINPROGRESS: return "A blocking call is in progress...";
+        case EALREADY: return "A nonblocking call is in progress...";
+        case EADDRNOTAVAIL: return "The specified address is not available...";
+        case EAFNOSUPPORT: return "Addresses in the specified family are not supported...";
+        case ECONNREFUSED: return "The attempt to connect was forcefully rejected...";
+        case EFAULT: return "A malformed argument was supplied to the connect() function...";
+        case EINVAL: return "An invalid argument was supplied to the connect() function...";
+        case EISCONN: return "The socket is already connected...";
+        case ENETUNREACH: return "The network cannot be reached from this host...";
+        case ENOBUFS: return "No buffer space is available for the socket...";
+        case ENOTSOCK: return "The descriptor to the connect() function is not a socket...";
+        case ETIMEDOUT: return "Attempt to connect timed out...";
+        case EWOULDBLOCK: return "A nonblocking call could not be completed immediately...";
+        case EACCES: return "The access to the socket is forbidden...";
+        case 0: return "";
+        default: return "An unspecified error occured...";
+    }
+}
+
+
+const char *GetSocketErrorMessage(void)
+{
+    return GetSocketErrorMessageAux(last_errno);
+}
@@ -18,6 +18,9 @@
 #define SL_ENORESP      9   /* No response */
 #define SL_ERECEIVE     10  /* Receive error */
 
+/* Maximum number of buffers written at once by DgramWriteV() */
+#define DGRAM_IOV_MAX   16
+
 #include <winsock2.h>    /* includes netinet/in.h's sockaddr_in */
 
 extern void SetTimeout(int, int);
@@ -34,6 +37,7 @@ extern int  DgramReceiveAny(int, char *, int);
 extern int  DgramReply(int, char *, int);
 extern int  DgramRead(int fd, char *rbuf, int size);
 extern int  DgramWrite(int fd, char *wbuf, int size);
+extern int  DgramWriteV(int fd, char **bufs, int *sizes, int count);
 extern char *DgramLastname(void);
 extern void DgramClose(int);
 extern void GetLocalHostName(char *, unsigned);
@@ -7,6 +7,10 @@
 #ifndef OBJECT_GEAR_COMMON_H
 #define OBJECT_GEAR_COMMON_H
 
+struct player;
+struct player_body;
+struct object;
+
 /*
  * Player equipment slot types
  */
@@ -440,6 +440,7 @@ struct actor_race
 struct player_upkeep
 {
     byte new_level_method;          /* Climb up stairs, down, or teleport level? */
+    bool limbo;                     /* Not placed on the new level yet */
     bool funeral;                   /* True if player is leaving */
     s16b new_spells;                /* Number of spells available */
     struct source health_who;       /* Who's shown on the health bar */
@@ -521,7 +522,8 @@ enum
 struct player_square
 {
     u16b feat;
-    bitflag *info;
+    bitflag info[SQUARE_SIZE];
+    u16b pile;                  /* Position in the list of known piles (+1, 0 if none) */
     struct object *obj;
     struct trap *trap;
 };
@@ -531,15 +533,45 @@ struct heatmap
     u16b **grids;
 };
 
+struct scentmap
+{
+    u32b **stamps;  /* Scent clock when the scent was laid, minus its initial value (0 = none) */
+    u32b clock;     /* Scent clock (increased every time the scent ages) */
+};
+
 struct player_cave
 {
     u16b feeling_squares;   /* How many feeling squares the player has visited */
     int height;
     int width;
-    struct player_square **squares;
+    struct player_square *squares;  /* All the grids, row by row (start of the memory block) */
     struct heatmap noise;
-    struct heatmap scent;
+    struct scentmap scent;
     bool allocated;
+
+    /* Noise field cache (recomputed when any of these changes) */
+    u32b noise_stamp;           /* Flow stamp of the level */
+    struct loc noise_source;    /* Noise source (player or decoy) */
+    struct loc noise_player;    /* Player grid */
+
+    /* Area holding all the viewable grids (set by update_view()) */
+    struct loc view_begin;
+    struct loc view_end;
+
+    /* Grids holding a known pile (so the object list doesn't scan the whole level) */
+    struct loc *piles;
+    int piles_num;
+    int piles_max;
+};
+
+/*
+ * What a player knows about another player on the same level
+ */
+struct player_vis
+{
+    s32b id;                    /* ID of the other player */
+    bitflag mflag[MFLAG_SIZE];  /* Temporary monster flags */
+    byte det;                   /* Was this player detected? */
 };
 
 /*
@@ -704,8 +736,12 @@ struct player
     byte special_file_type;                         /* Type of info browsed by this player */
     bitflag (*mflag)[MFLAG_SIZE];                   /* Temporary monster flags */
     byte *mon_det;                                  /* Were these monsters detected by this player? */
-    bitflag pflag[MAX_PLAYERS][MFLAG_SIZE];         /* Temporary monster flags (players) */
-    byte play_det[MAX_PLAYERS];                     /* Were these players detected by this player? */
+    s16b *mon_seen;                                 /* Monsters seen by this player (for the monster list) */
+    u16b *mon_seen_pos;                             /* Position of each monster in the above (+1, 0 if none) */
+    int mon_seen_num;                               /* Number of entries in the above */
+    struct player_vis *play_vis;                    /* Players seen or detected by this player */
+    int play_vis_num;                               /* Number of entries in the above */
+    int play_vis_max;                               /* Number of allocated entries */
     byte *d_attr;
     char *d_char;
     byte (*f_attr)[LIGHTING_MAX];
@@ -728,6 +764,10 @@ struct player
     struct loc old_offset_grid;
     cave_view_type **scr_info;
     cave_view_type **trn_info;
+    bitflag **scr_dirty;                    /* Grids of scr_info/trn_info not sent yet */
+    bitflag *scr_dirty_rows;                /* Rows containing such grids */
+    bitflag **link_dirty;                   /* Same, for a player mind-linked to this one */
+    bitflag *link_dirty_rows;               /* Rows containing such grids */
     char msg_log[MAX_MSG_HIST][NORMAL_WID]; /* Message history log */
     s16b msg_hist_ptr;                      /* Where will the next message be stored */
     byte last_dir;                          /* Last direction moved (used for swapping places) */
@@ -819,3 +819,97 @@ int Packet_scanf(sockbuf_t *sbuf, char *fmt, ...)
 
     return (failure? -1: count);
 }
+
+
+
+/*
+ * Check that a packet of the given size fits in the buffer
+ *
+ * Like Packet_printf(), return 0 if it doesn't fit in a datagram socket buffer, and -1 if
+ * it doesn't fit in a stream socket buffer.
+ */
+static int packet_fits(sockbuf_t *sbuf, int size)
+{
+    if (sbuf->len + size < sbuf->size) return 1;
+
+    return ((BIT(sbuf->state, SOCKBUF_DGRAM) != 0)? 0: -1);
+}
+
+
+/*
+ * Check that a packet of the given size has been received
+ *
+ * Like Packet_scanf(), try to read more data from a stream socket if needed, and return 0
+ * if the packet is not complete.
+ */
+static int packet_ready(sockbuf_t *sbuf, int size)
+{
+    if (&sbuf->buf[sbuf->len] >= &sbuf->ptr[size]) return 1;
+
+    if (BIT(sbuf->state, SOCKBUF_DGRAM | SOCKBUF_LOCK) != 0) return 0;
+    if (Sockbuf_read(sbuf) == -1) return -1;
+    if (&sbuf->buf[sbuf->len] >= &sbuf->ptr[size]) return 1;
+
+    return 0;
+}
+
+
+/*
+ * Fixed packet layouts (see list-packet-layouts.h)
+ *
+ * Fields are encoded exactly like Packet_printf() and Packet_scanf() do.
+ */
+#define PKT_SIZE_b  1
+#define PKT_SIZE_c  1
+#define PKT_SIZE_hd 2
+#define PKT_SIZE_hu 2
+#define PKT_SIZE_ld 4
+#define PKT_SIZE_lu 4
+
+#define PKT_PUT_b(F)    *pkt_buf++ = (F);
+#define PKT_PUT_c(F)    *pkt_buf++ = (F);
+#define PKT_PUT_hd(F)   *pkt_buf++ = (F) >> 8; *pkt_buf++ = (F);
+#define PKT_PUT_hu(F)   *pkt_buf++ = (F) >> 8; *pkt_buf++ = (F);
+#define PKT_PUT_ld(F) \
+    *pkt_buf++ = (F) >> 24; *pkt_buf++ = (F) >> 16; *pkt_buf++ = (F) >> 8; *pkt_buf++ = (F);
+#define PKT_PUT_lu(F) \
+    *pkt_buf++ = (F) >> 24; *pkt_buf++ = (F) >> 16; *pkt_buf++ = (F) >> 8; *pkt_buf++ = (F);
+#define PKT_PUT(T, F)   PKT_PUT_##T(F)
+
+#define PKT_GET_b(F)    *(F) = (*pkt_ptr++ & 0xFF);
+#define PKT_GET_c(F)    *(F) = *pkt_ptr++;
+#define PKT_GET_hd(F) \
+    *(F) = pkt_ptr[0] << 8; *(F) |= (pkt_ptr[1] & 0xFF); pkt_ptr += 2;
+#define PKT_GET_hu(F) \
+    *(F) = (pkt_ptr[0] & 0xFF) << 8; *(F) |= (pkt_ptr[1] & 0xFF); pkt_ptr += 2;
+#define PKT_GET_ld(F) \
+    *(F) = pkt_ptr[0] << 24; *(F) |= (pkt_ptr[1] & 0xFF) << 16; \
+    *(F) |= (pkt_ptr[2] & 0xFF) << 8; *(F) |= (pkt_ptr[3] & 0xFF); pkt_ptr += 4;
+#define PKT_GET_lu(F) \
+    *(F) = (pkt_ptr[0] & 0xFF) << 24; *(F) |= (pkt_ptr[1] & 0xFF) << 16; \
+    *(F) |= (pkt_ptr[2] & 0xFF) << 8; *(F) |= (pkt_ptr[3] & 0xFF); pkt_ptr += 4;
+#define PKT_GET(T, F)   PKT_GET_##T(F)
+
+#define PKT_FUNCS(N, ARGS, PTRS, SIZE, PUT, GET, COUNT) \
+    int Packet_put_##N(sockbuf_t *sbuf ARGS) \
+    { \
+        char *pkt_buf; \
+        int pkt_n = packet_fits(sbuf, SIZE); \
+        if (pkt_n <= 0) return pkt_n; \
+        pkt_buf = sbuf->buf + sbuf->len; \
+        PUT \
+        sbuf->len += SIZE; \
+        return SIZE; \
+    } \
+    int Packet_get_##N(sockbuf_t *sbuf PTRS) \
+    { \
+        char *pkt_ptr; \
+        int pkt_n = packet_ready(sbuf, SIZE); \
+        if (pkt_n <= 0) return pkt_n; \
+        pkt_ptr = sbuf->ptr; \
+        GET \
+        sbuf->ptr = pkt_ptr; \
+        return COUNT; \
+    }
+#include "list-packet-layouts.h"
+#undef PKT_FUNCS
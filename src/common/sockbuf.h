@@ -53,4 +53,93 @@ extern int Sockbuf_copy(sockbuf_t *dest, sockbuf_t *src, int len);
 extern int Packet_printf(sockbuf_t *, char *fmt, ...);
 extern int Packet_scanf(sockbuf_t *, char *fmt, ...);
 
+/*
+ * Fixed packet layouts (see list-packet-layouts.h)
+ *
+ * PKT_LAYOUTn() turns a layout with n fields into a call to PKT_FUNCS(), which gets the
+ * name of the layout, the parameters of Packet_put_<name>() and Packet_get_<name>(), the
+ * size of the packet, the code writing and reading each field, and the number of fields.
+ * PKT_FUNCS() is defined here to declare the functions, and in sockbuf.c to define them.
+ */
+#define PKT_TYPE_b  byte
+#define PKT_TYPE_c  char
+#define PKT_TYPE_hd s16b
+#define PKT_TYPE_hu u16b
+#define PKT_TYPE_ld s32b
+#define PKT_TYPE_lu u32b
+
+#define PKT_ARG(T, F)   , PKT_TYPE_##T F
+#define PKT_PTR(T, F)   , PKT_TYPE_##T *F
+
+#define PKT_LAYOUT1(N, T1, F1) \
+    PKT_FUNCS(N, \
+        PKT_ARG(T1, F1), \
+        PKT_PTR(T1, F1), \
+        PKT_SIZE_##T1, \
+        PKT_PUT(T1, F1), \
+        PKT_GET(T1, F1), 1)
+#define PKT_LAYOUT2(N, T1, F1, T2, F2) \
+    PKT_FUNCS(N, \
+        PKT_ARG(T1, F1) PKT_ARG(T2, F2), \
+        PKT_PTR(T1, F1) PKT_PTR(T2, F2), \
+        PKT_SIZE_##T1 + PKT_SIZE_##T2, \
+        PKT_PUT(T1, F1) PKT_PUT(T2, F2), \
+        PKT_GET(T1, F1) PKT_GET(T2, F2), 2)
+#define PKT_LAYOUT3(N, T1, F1, T2, F2, T3, F3) \
+    PKT_FUNCS(N, \
+        PKT_ARG(T1, F1) PKT_ARG(T2, F2) PKT_ARG(T3, F3), \
+        PKT_PTR(T1, F1) PKT_PTR(T2, F2) PKT_PTR(T3, F3), \
+        PKT_SIZE_##T1 + PKT_SIZE_##T2 + PKT_SIZE_##T3, \
+        PKT_PUT(T1, F1) PKT_PUT(T2, F2) PKT_PUT(T3, F3), \
+        PKT_GET(T1, F1) PKT_GET(T2, F2) PKT_GET(T3, F3), 3)
+#define PKT_LAYOUT4(N, T1, F1, T2, F2, T3, F3, T4, F4) \
+    PKT_FUNCS(N, \
+        PKT_ARG(T1, F1) PKT_ARG(T2, F2) PKT_ARG(T3, F3) PKT_ARG(T4, F4), \
+        PKT_PTR(T1, F1) PKT_PTR(T2, F2) PKT_PTR(T3, F3) PKT_PTR(T4, F4), \
+        PKT_SIZE_##T1 + PKT_SIZE_##T2 + PKT_SIZE_##T3 + PKT_SIZE_##T4, \
+        PKT_PUT(T1, F1) PKT_PUT(T2, F2) PKT_PUT(T3, F3) PKT_PUT(T4, F4), \
+        PKT_GET(T1, F1) PKT_GET(T2, F2) PKT_GET(T3, F3) PKT_GET(T4, F4), 4)
+#define PKT_LAYOUT5(N, T1, F1, T2, F2, T3, F3, T4, F4, T5, F5) \
+    PKT_FUNCS(N, \
+        PKT_ARG(T1, F1) PKT_ARG(T2, F2) PKT_ARG(T3, F3) PKT_ARG(T4, F4) \
+        PKT_ARG(T5, F5), \
+        PKT_PTR(T1, F1) PKT_PTR(T2, F2) PKT_PTR(T3, F3) PKT_PTR(T4, F4) \
+        PKT_PTR(T5, F5), \
+        PKT_SIZE_##T1 + PKT_SIZE_##T2 + PKT_SIZE_##T3 + PKT_SIZE_##T4 + \
+        PKT_SIZE_##T5, \
+        PKT_PUT(T1, F1) PKT_PUT(T2, F2) PKT_PUT(T3, F3) PKT_PUT(T4, F4) \
+        PKT_PUT(T5, F5), \
+        PKT_GET(T1, F1) PKT_GET(T2, F2) PKT_GET(T3, F3) PKT_GET(T4, F4) \
+        PKT_GET(T5, F5), 5)
+#define PKT_LAYOUT6(N, T1, F1, T2, F2, T3, F3, T4, F4, T5, F5, T6, F6) \
+    PKT_FUNCS(N, \
+        PKT_ARG(T1, F1) PKT_ARG(T2, F2) PKT_ARG(T3, F3) PKT_ARG(T4, F4) \
+        PKT_ARG(T5, F5) PKT_ARG(T6, F6), \
+        PKT_PTR(T1, F1) PKT_PTR(T2, F2) PKT_PTR(T3, F3) PKT_PTR(T4, F4) \
+        PKT_PTR(T5, F5) PKT_PTR(T6, F6), \
+        PKT_SIZE_##T1 + PKT_SIZE_##T2 + PKT_SIZE_##T3 + PKT_SIZE_##T4 + \
+        PKT_SIZE_##T5 + PKT_SIZE_##T6, \
+        PKT_PUT(T1, F1) PKT_PUT(T2, F2) PKT_PUT(T3, F3) PKT_PUT(T4, F4) \
+        PKT_PUT(T5, F5) PKT_PUT(T6, F6), \
+        PKT_GET(T1, F1) PKT_GET(T2, F2) PKT_GET(T3, F3) PKT_GET(T4, F4) \
+        PKT_GET(T5, F5) PKT_GET(T6, F6), 6)
+#define PKT_LAYOUT7(N, T1, F1, T2, F2, T3, F3, T4, F4, T5, F5, T6, F6, T7, F7) \
+    PKT_FUNCS(N, \
+        PKT_ARG(T1, F1) PKT_ARG(T2, F2) PKT_ARG(T3, F3) PKT_ARG(T4, F4) \
+        PKT_ARG(T5, F5) PKT_ARG(T6, F6) PKT_ARG(T7, F7), \
+        PKT_PTR(T1, F1) PKT_PTR(T2, F2) PKT_PTR(T3, F3) PKT_PTR(T4, F4) \
+        PKT_PTR(T5, F5) PKT_PTR(T6, F6) PKT_PTR(T7, F7), \
+        PKT_SIZE_##T1 + PKT_SIZE_##T2 + PKT_SIZE_##T3 + PKT_SIZE_##T4 + \
+        PKT_SIZE_##T5 + PKT_SIZE_##T6 + PKT_SIZE_##T7, \
+        PKT_PUT(T1, F1) PKT_PUT(T2, F2) PKT_PUT(T3, F3) PKT_PUT(T4, F4) \
+        PKT_PUT(T5, F5) PKT_PUT(T6, F6) PKT_PUT(T7, F7), \
+        PKT_GET(T1, F1) PKT_GET(T2, F2) PKT_GET(T3, F3) PKT_GET(T4, F4) \
+        PKT_GET(T5, F5) PKT_GET(T6, F6) PKT_GET(T7, F7), 7)
+
+#define PKT_FUNCS(N, ARGS, PTRS, SIZE, PUT, GET, COUNT) \
+    extern int Packet_put_##N(sockbuf_t *sbuf ARGS); \
+    extern int Packet_get_##N(sockbuf_t *sbuf PTRS);
+#include "list-packet-layouts.h"
+#undef PKT_FUNCS
+
 #endif
@@ -20,13 +20,20 @@
 
 #include "angband.h"
 #include <sys/stat.h>
-#include <dir.h>
+#ifdef WINDOWS
+# include <dir.h>
+#else
+# include <sys/types.h>
+# include <dirent.h>
+#endif
 
 
+#ifdef WINDOWS
 /*
  * Hack -- fake declarations from "dos.h" XXX XXX XXX
  */
 #define INVALID_FILE_NAME (DWORD)0xFFFFFFFF
+#endif
 
 
 /*
@@ -162,6 +169,7 @@ bool file_move(const char *fname, const char *newname)
  */
 bool file_exists(const char *fname)
 {
+#ifdef WINDOWS
     char path[MAX_PATH];
     DWORD attrib;
 
@@ -173,6 +181,13 @@ bool file_exists(const char *fname)
     if (attrib & FILE_ATTRIBUTE_DIRECTORY) return false;
 
     return true;
+#else
+    struct stat st;
+
+    if (stat(fname, &st) != 0) return false;
+
+    return (S_ISDIR(st.st_mode)? false: true);
+#endif
 }
 
 
@@ -183,8 +198,10 @@ bool file_newer(const char *first, const char *second)
 {
     struct stat stat1, stat2;
 
+#ifdef WINDOWS
     /* Remove W8080 warning: _fstat is declared but never used */
     _fstat(0, NULL);
+#endif
 
     /* If the first doesn't exist, the first is not newer. */
     if (stat(first, &stat1) != 0) return false;
@@ -277,10 +294,20 @@ ang_file *file_temp(char *fname, size_t len)
 {
     ang_file *fff;
     char prefix[] = "mng";
+#ifndef WINDOWS
+    int fd;
+#endif
 
     /* Temporary file */
+#ifdef WINDOWS
     if (!GetTempPath(len, fname)) return NULL;
     if (!GetTempFileName(fname, prefix, 0, fname)) return NULL;
+#else
+    strnfmt(fname, len, "/tmp/%sXXXXXX", prefix);
+    fd = mkstemp(fname);
+    if (fd < 0) return NULL;
+    close(fd);
+#endif
 
     /* Open a new file */
     fff = file_open(fname, MODE_WRITE, FTYPE_TEXT);
@@ -515,6 +542,7 @@ void file_rewind(ang_file *f)
  */
 bool dir_exists(const char *path)
 {
+#ifdef WINDOWS
     char dirpath[MAX_PATH];
     DWORD attrib;
 
@@ -526,6 +554,26 @@ bool dir_exists(const char *path)
     if (attrib & FILE_ATTRIBUTE_DIRECTORY) return true;
 
     return false;
+#else
+    struct stat buf;
+
+    if (stat(path, &buf) != 0) return false;
+
+    return (S_ISDIR(buf.st_mode)? true: false);
+#endif
+}
+
+
+/*
+ * Create a single directory
+ */
+static int mkdir_aux(const char *path)
+{
+#ifdef WINDOWS
+    return mkdir(path);
+#else
+    return mkdir(path, 0755);
+#endif
 }
 
 
@@ -572,11 +620,11 @@ bool dir_create(const char *path)
             if (dir_exists(buf)) continue;
 
             /* The parent doesn't exist, so create it or fail */
-            if (mkdir(buf) != 0) return false;
+            if (mkdir_aux(buf) != 0) return false;
         }
     }
 
-    return (mkdir(path) == 0)? true: false;
+    return (mkdir_aux(path) == 0)? true: false;
 }
 
 
@@ -585,6 +633,8 @@ bool dir_create(const char *path)
  */
 
 
+#ifdef WINDOWS
+
 /* System-specific struct */
 struct ang_dir
 {
@@ -665,4 +715,76 @@ void my_dclose(ang_dir *dir)
     mem_free(dir);
 }
 
+#else
+
+/* System-specific struct */
+struct ang_dir
+{
+    DIR *d;
+    char *dirname;
+};
+
+
+ang_dir *my_dopen(const char *dirname)
+{
+    ang_dir *dir;
+    DIR *d;
+
+    /* Try to open the directory */
+    d = opendir(dirname);
+    if (!d) return NULL;
+
+    /* Allocate memory for the handle */
+    dir = mem_zalloc(sizeof(ang_dir));
+    dir->d = d;
+    dir->dirname = string_make(dirname);
+
+    /* Success */
+    return dir;
+}
+
+
+bool my_dread(ang_dir *dir, char *fname, size_t len)
+{
+    struct dirent *entry;
+    struct stat filedata;
+    char path[MSG_LEN];
+
+    /* Try reading another entry */
+    while (1)
+    {
+        entry = readdir(dir->d);
+        if (!entry) return false;
+
+        path_build(path, sizeof(path), dir->dirname, entry->d_name);
+
+        /* Check to see if it exists */
+        if (stat(path, &filedata) != 0) continue;
+
+        /* Check to see if it's a directory */
+        if (S_ISDIR(filedata.st_mode)) continue;
+
+        /* We've found something worth returning */
+        break;
+    }
+
+    /* Copy the filename */
+    my_strcpy(fname, entry->d_name, len);
+
+    return true;
+}
+
+
+void my_dclose(ang_dir *dir)
+{
+    /* Close directory */
+    if (dir->d) closedir(dir->d);
+
+    /* Free memory */
+    string_free(dir->dirname);
+    mem_free(dir);
+}
+
+#endif
+
 
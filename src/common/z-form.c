@@ -583,7 +583,13 @@ static char *format_buf[FORMAT_CYCLE_MAX] = { NULL };
 static size_t format_len[FORMAT_CYCLE_MAX] = { 0 };
 
 
+#if defined(va_copy)
+#define VA_COPY(DST, SRC) va_copy(DST, SRC)
+#elif defined(__va_copy)
+#define VA_COPY(DST, SRC) __va_copy(DST, SRC)
+#else
 #define VA_COPY(DST, SRC) (DST) = (SRC)
+#endif
 
 
 /*
@@ -20,80 +20,410 @@
 #include "s-angband.h"
 
 
-u32b get_account(const char *name, const char *pass)
+/*
+ * The accounts are kept in the "account" file of the save directory, which holds the name
+ * and the password of each account on two consecutive lines. The ID of an account is its
+ * position in the file, so the file is only ever appended to.
+ *
+ * The whole file is loaded when the network server is set up: the accounts are kept in an
+ * array (indexed by ID) along with a hash table of their names, so a login never touches
+ * the disk unless a new account is created.
+ *
+ * Passwords are stored as a salted MD5 hash ("<salt>$1$<hash>"). Files written by older
+ * servers (plaintext passwords, no header line) are converted when loaded: the file is
+ * rewritten in place with the accounts in the same order, so account IDs don't change.
+ * The same happens if the last record was only partially written.
+ */
+
+
+/* Header line of the account file (a name can't start with '#') */
+#define ACCOUNT_HEADER  "# Accounts: name and salted password hash on alternate lines"
+
+
+/* Length of the salt (in hex digits) */
+#define ACCOUNT_SALT_LEN    8
+
+
+/*
+ * An account
+ */
+struct account
+{
+    char *name;                 /* Lowercase account name */
+    char pass[48];              /* Salted password hash */
+    u32b next;                  /* Next account in the hash chain (ID, 0 if none) */
+};
+
+
+/* Accounts, indexed by ID - 1 */
+static struct account *accounts;
+static u32b accounts_num;
+static u32b accounts_max;
+
+
+/* Hash table of the account names (power of 2 size, holds account IDs) */
+static u32b *account_hash;
+static u32b account_hash_size;
+
+
+/* Account file */
+static char account_file[MSG_LEN];
+static ang_file *account_log;
+
+
+/* Salt generator */
+static u32b account_salt_state;
+
+
+/*
+ * Lowercase copy of an account name
+ */
+static void account_name(char *buf, size_t len, const char *name)
 {
-    ang_file *fh;
-    char filename[MSG_LEN];
-    char filebuf[MSG_LEN];
-    u32b account_id = 1;
-    bool check_name = true, name_ok = false, pass_ok = false;
     char *str;
 
-    /* Check account file */
-    path_build(filename, sizeof(filename), ANGBAND_DIR_SAVE, "account");
-    if (file_exists(filename))
+    my_strcpy(buf, name, len);
+    for (str = buf; *str; str++) *str = tolower((unsigned char)*str);
+}
+
+
+/*
+ * Hash a password with the given salt
+ */
+static void account_hash_pass(char *buf, size_t len, const char *salt, const char *pass)
+{
+    char tmp[MSG_LEN];
+
+    strnfmt(tmp, sizeof(tmp), "%s%s", salt, pass);
+    MD5Password(tmp);
+    strnfmt(buf, len, "%s%s", salt, tmp);
+}
+
+
+/*
+ * Hash a password with a new salt
+ */
+static void account_new_pass(char *buf, size_t len, const char *pass)
+{
+    char salt[ACCOUNT_SALT_LEN + 1];
+
+    /* Xorshift, seeded from the clock */
+    if (!account_salt_state)
+        account_salt_state = ((u32b)time(NULL) ^ (u32b)profile_ticks()) | 1;
+    account_salt_state ^= account_salt_state << 13;
+    account_salt_state ^= account_salt_state >> 17;
+    account_salt_state ^= account_salt_state << 5;
+
+    strnfmt(salt, sizeof(salt), "%08lx", (unsigned long)account_salt_state);
+    account_hash_pass(buf, len, salt, pass);
+}
+
+
+/*
+ * Check a password against a stored hash
+ */
+static bool account_check_pass(const struct account *acc, const char *pass)
+{
+    char salt[ACCOUNT_SALT_LEN + 1];
+    char hash[sizeof(acc->pass)];
+
+    my_strcpy(salt, acc->pass, sizeof(salt));
+    account_hash_pass(hash, sizeof(hash), salt, pass);
+
+    return streq(hash, acc->pass);
+}
+
+
+/*
+ * Find an account by (lowercase) name
+ */
+static u32b account_find(const char *name)
+{
+    u32b id;
+
+    if (!account_hash_size) return 0;
+
+    id = account_hash[djb2_hash(name) & (account_hash_size - 1)];
+    while (id && !streq(accounts[id - 1].name, name)) id = accounts[id - 1].next;
+
+    return id;
+}
+
+
+/*
+ * Add an account to the hash table, growing the table if needed
+ */
+static void account_hash_add(u32b id)
+{
+    u32b slot;
+
+    /* Keep the chains short */
+    if (accounts_num > account_hash_size)
     {
-        /* Open the file */
-        fh = file_open(filename, MODE_READ, FTYPE_TEXT);
-        if (!fh)
+        u32b i;
+
+        account_hash_size = (account_hash_size? account_hash_size * 2: 1024);
+        mem_free(account_hash);
+        account_hash = mem_zalloc(account_hash_size * sizeof(u32b));
+
+        /* Rehash, keeping the first account of a given name in front */
+        for (i = accounts_num; i > 0; i--)
         {
-            plog("Failed to open account file!");
-            return 0L;
+            if (i == id) continue;
+            slot = djb2_hash(accounts[i - 1].name) & (account_hash_size - 1);
+            accounts[i - 1].next = account_hash[slot];
+            account_hash[slot] = i;
         }
+    }
+
+    slot = djb2_hash(accounts[id - 1].name) & (account_hash_size - 1);
+    accounts[id - 1].next = account_hash[slot];
+    account_hash[slot] = id;
+}
+
+
+/*
+ * Add an account to memory, return its ID
+ */
+static u32b account_add(const char *name, const char *pass)
+{
+    struct account *acc;
+
+    if (accounts_num == accounts_max)
+    {
+        accounts_max = (accounts_max? accounts_max * 2: 256);
+        accounts = mem_realloc(accounts, accounts_max * sizeof(struct account));
+    }
+
+    acc = &accounts[accounts_num++];
+    acc->name = string_make(name);
+    my_strcpy(acc->pass, pass, sizeof(acc->pass));
+
+    /* Only index the first account of a given name (old files may have duplicates) */
+    acc->next = 0;
+    if (!account_find(name)) account_hash_add(accounts_num);
+
+    return accounts_num;
+}
+
+
+/*
+ * Open the account file for appending
+ */
+static bool account_open_log(void)
+{
+    bool exists = file_exists(account_file);
+
+    account_log = file_open(account_file, MODE_APPEND, FTYPE_TEXT);
+    if (!account_log) return false;
+
+    if (!exists) file_putf(account_log, "%s\n", ACCOUNT_HEADER);
 
-        /* Process the file */
-        while (file_getl(fh, filebuf, sizeof(filebuf)))
+    return true;
+}
+
+
+/*
+ * Rewrite the account file from memory
+ */
+static bool account_compact(void)
+{
+    char filename[MSG_LEN];
+    ang_file *fh;
+    u32b i;
+    bool ok = true;
+
+    if (account_log) file_close(account_log);
+    account_log = NULL;
+
+    strnfmt(filename, sizeof(filename), "%s.new", account_file);
+    fh = file_open(filename, MODE_WRITE, FTYPE_TEXT);
+    if (!fh) return false;
+
+    file_putf(fh, "%s\n", ACCOUNT_HEADER);
+    for (i = 0; i < accounts_num; i++)
+    {
+        if (!file_putf(fh, "%s\n%s\n", accounts[i].name, accounts[i].pass)) ok = false;
+    }
+    if (!file_close(fh)) ok = false;
+
+#ifdef WINDOWS
+    /* Windows won't rename over an existing file: keep the old one until the new one is in place */
+    if (ok)
+    {
+        char backup[MSG_LEN];
+
+        strnfmt(backup, sizeof(backup), "%s.bak", account_file);
+        file_delete(backup);
+        if (file_exists(account_file) && !file_move(account_file, backup)) ok = false;
+        else if (!file_move(filename, account_file))
         {
-            /* Get account name */
-            if (check_name) name_ok = !my_stricmp(filebuf, name);
-
-            /* Get account password */
-            else pass_ok = streq(filebuf, pass);
-
-            /* Check name + password */
-            check_name = !check_name;
-            if (check_name)
-            {
-                /* Same name */
-                if (name_ok)
-                {
-                    /* Same password */
-                    if (pass_ok) break;
-
-                    /* Incorrect password */
-                    return 0L;
-                }
-                name_ok = false;
-                pass_ok = false;
-                account_id++;
-            }
+            file_move(backup, account_file);
+            ok = false;
         }
+        else
+            file_delete(backup);
+    }
+#else
+    /* Replace the old file in one step */
+    if (ok) ok = file_move(filename, account_file);
+#endif
 
-        /* Close the file */
-        file_close(fh);
+    if (!ok) file_delete(filename);
 
-        /* Found a match */
-        if (name_ok && pass_ok) return account_id;
-    }
+    return ok;
+}
 
-    /* Append to the file */
-    fh = file_open(filename, MODE_APPEND, FTYPE_TEXT);
+
+/*
+ * Forget all accounts
+ */
+void accounts_free(void)
+{
+    u32b i;
+
+    if (account_log) file_close(account_log);
+    account_log = NULL;
+
+    for (i = 0; i < accounts_num; i++) string_free(accounts[i].name);
+    mem_free(accounts);
+    accounts = NULL;
+    accounts_num = accounts_max = 0;
+
+    mem_free(account_hash);
+    account_hash = NULL;
+    account_hash_size = 0;
+}
+
+
+/*
+ * Load the accounts from the given file
+ */
+bool accounts_load(const char *filename)
+{
+    ang_file *fh;
+    char name[MSG_LEN];
+    char line[MSG_LEN];
+    char pass[MSG_LEN];
+    bool header = false, partial = false;
+
+    accounts_free();
+    my_strcpy(account_file, filename, sizeof(account_file));
+
+    /* No accounts yet: the file is created with the first account */
+    if (!file_exists(account_file)) return true;
+
+    fh = file_open(account_file, MODE_READ, FTYPE_TEXT);
     if (!fh)
     {
         plog("Failed to open account file!");
-        return 0L;
+        return false;
     }
 
-    /* Lowercase account name */
-    my_strcpy(filebuf, name, sizeof(filebuf));
-    for (str = filebuf; *str; str++) *str = tolower((unsigned char)*str);
+    /* Old files have no header and store the passwords as sent by the client */
+    if (file_getl(fh, line, sizeof(line)))
+    {
+        if (line[0] == '#') header = true;
+        else
+        {
+            my_strcpy(name, line, sizeof(name));
+            partial = true;
+        }
+    }
 
-    /* Create new account */
-    file_putf(fh, "%s\n", filebuf);
-    file_putf(fh, "%s\n", pass);
+    /* Read the records */
+    while (file_getl(fh, line, sizeof(line)))
+    {
+        if (!partial)
+        {
+            my_strcpy(name, line, sizeof(name));
+            partial = true;
+            continue;
+        }
+
+        if (!header)
+        {
+            char buf[MSG_LEN];
+
+            account_name(buf, sizeof(buf), name);
+            account_new_pass(pass, sizeof(pass), line);
+            account_add(buf, pass);
+        }
+        else
+            account_add(name, line);
+        partial = false;
+    }
 
-    /* Close */
     file_close(fh);
 
-    return account_id;
+    /* Convert old files, drop incomplete records */
+    if (!header || partial)
+    {
+        if (partial) plog("Dropping incomplete record at the end of the account file");
+        if (!header) plog_fmt("Converting account file (%lu accounts)", (unsigned long)accounts_num);
+        if (!account_compact())
+        {
+            plog("Failed to rewrite account file!");
+            return false;
+        }
+    }
+
+    return true;
+}
+
+
+/*
+ * Load the accounts from the save directory
+ */
+bool accounts_init(void)
+{
+    char filename[MSG_LEN];
+
+    path_build(filename, sizeof(filename), ANGBAND_DIR_SAVE, "account");
+    if (!accounts_load(filename)) return false;
+
+    plog_fmt("Loaded %lu accounts", (unsigned long)accounts_num);
+    return true;
+}
+
+
+/*
+ * Check a name/password pair, creating a new account if the name is unknown.
+ *
+ * Return the account ID, or 0 if the password is incorrect (or on error).
+ */
+u32b get_account(const char *name, const char *pass)
+{
+    char buf[MSG_LEN];
+    char hash[MSG_LEN];
+    u32b account_id;
+
+    /* Existing account */
+    account_name(buf, sizeof(buf), name);
+    account_id = account_find(buf);
+    if (account_id)
+    {
+        if (account_check_pass(&accounts[account_id - 1], pass)) return account_id;
+
+        /* Incorrect password */
+        return 0L;
+    }
+
+    /* Append to the file */
+    if (!account_log && !account_open_log())
+    {
+        plog("Failed to open account file!");
+        return 0L;
+    }
+
+    /* Create new account */
+    account_new_pass(hash, sizeof(hash), pass);
+    if (!file_putf(account_log, "%s\n%s\n", buf, hash))
+    {
+        plog("Failed to write account file!");
+        return 0L;
+    }
+    file_flush(account_log);
+
+    return account_add(buf, hash);
 }
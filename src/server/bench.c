@@ -0,0 +1,775 @@
+/*
+ * File: bench.c
+ * Purpose: Headless benchmark mode
+ *
+ * Copyright (c) 2019 MAngband and PWMAngband Developers
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+
+#include "s-angband.h"
+
+
+/*
+ * When started with "--bench N", the server doesn't open the contact socket and doesn't
+ * enter the scheduler. Instead, a few scripted players are created on socketless
+ * connections, and run_game_loop() is called N times in a row as fast as possible.
+ * The time spent in each phase of the game turn is then reported in the log.
+ *
+ * The RNG is seeded with a fixed value, so two runs from the same (empty) save directory
+ * perform exactly the same work.
+ */
+
+
+/* Number of scripted players */
+#define BENCH_BOTS  16
+
+
+/* Number of times the screens of the bots are encoded/decoded by the packet benchmark */
+#define BENCH_PACKET_PASSES 200
+
+
+/* Number of accounts created by the account benchmark */
+#define BENCH_ACCOUNTS  100000
+
+
+/* Number of objects dropped in town by the object list benchmark, and number of passes */
+#define BENCH_OBJECTS       2000
+#define BENCH_OBJLIST_PASSES 100
+
+
+/* Number of random artifacts described by the randart benchmark, and number of passes */
+#define BENCH_RANDARTS          200
+#define BENCH_RANDART_PASSES    20
+
+
+/* Number of objects created and freed by the object pool benchmark, and number of passes */
+#define BENCH_POOL_OBJECTS  4000
+#define BENCH_POOL_PASSES   50
+
+
+/* Number of turns between two waves of level changes (half of the bots go deeper at once) */
+#define BENCH_LEVEL_PERIOD  1000
+
+
+/* Number of game turns to run (0 if the benchmark mode is disabled) */
+u32b bench_turns = 0;
+
+
+static const char *bench_phase_name[BENCH_MAX] =
+{
+    "pre_turn_game_loop",
+    "process_player",
+    "post_turn_game_loop",
+    "Net_output"
+};
+
+
+/* Accumulated time (in ns) per phase */
+static u64b bench_total[BENCH_MAX];
+
+
+/* Slowest turn (in ns) per phase */
+static u64b bench_worst[BENCH_MAX];
+
+
+/* Amount of data sent to the bots */
+static u64b bench_bytes;
+
+
+/* Changed grids of the map sent to the bots (this turn, in total, worst turn) */
+static long bench_map_cells, bench_map_bytes, bench_map_single;
+static u64b bench_map_total[3];
+static long bench_map_worst;
+
+
+/*
+ * Turns spent in limbo by the bots changing level: turn of the level change for each bot
+ * (0 when the bot is not in limbo), number of level changes, total and worst number of
+ * turns
+ */
+static u32b bench_limbo_turn[BENCH_BOTS + 1];
+static long bench_limbo_count, bench_limbo_turns, bench_limbo_worst;
+
+
+/*
+ * Account the time elapsed since "start" to the given phase
+ */
+void bench_add(int phase, u64b start)
+{
+    u64b elapsed = profile_ticks() - start;
+
+    bench_total[phase] += elapsed;
+    if (elapsed > bench_worst[phase]) bench_worst[phase] = elapsed;
+}
+
+
+/*
+ * Account data sent to a bot
+ */
+void bench_sent(long len)
+{
+    bench_bytes += len;
+}
+
+
+/*
+ * Account changed grids of the map sent to a bot ("single" is what they would have cost
+ * as PKT_CHAR packets)
+ */
+void bench_map(int cells, int bytes, int single)
+{
+    bench_map_cells += cells;
+    bench_map_bytes += bytes;
+    bench_map_single += single;
+}
+
+
+/*
+ * Account the changed grids of the map sent during the last turn
+ */
+static void bench_map_turn(void)
+{
+    bench_map_total[0] += bench_map_cells;
+    bench_map_total[1] += bench_map_bytes;
+    bench_map_total[2] += bench_map_single;
+    if (bench_map_bytes > bench_map_worst) bench_map_worst = bench_map_bytes;
+
+    bench_map_cells = bench_map_bytes = bench_map_single = 0;
+}
+
+
+/*
+ * Send a bot to a new dungeon level, and remember when it entered limbo
+ */
+static void bench_change_level(int i, struct loc *grid, int depth, u32b n)
+{
+    struct player *p = player_get(i);
+    struct worldpos wpos;
+
+    wpos_init(&wpos, grid, depth);
+    dungeon_change_level(p, chunk_get(&p->wpos), &wpos, LEVEL_RAND);
+
+    if (i > BENCH_BOTS) return;
+    bench_limbo_turn[i] = n + 1;
+}
+
+
+/*
+ * Check which bots have left limbo during the last game turn
+ */
+static void bench_limbo_check(u32b n)
+{
+    int i;
+
+    for (i = 1; (i <= NumPlayers) && (i <= BENCH_BOTS); i++)
+    {
+        struct player *p = player_get(i);
+        long turns;
+
+        if (!bench_limbo_turn[i] || p->upkeep->new_level_method) continue;
+
+        /* Number of extra turns spent in limbo (0 if the level was ready at once) */
+        turns = (long)(n + 1 - bench_limbo_turn[i]);
+
+        bench_limbo_count++;
+        bench_limbo_turns += turns;
+        if (turns > bench_limbo_worst) bench_limbo_worst = turns;
+
+        bench_limbo_turn[i] = 0;
+    }
+}
+
+
+/*
+ * Send half of the bots one wave deeper into the deepest dungeon, all at once. Each bot
+ * gets its own new level, since players can't share a level that hasn't been generated
+ * yet.
+ */
+static void bench_level_wave(u32b n)
+{
+    struct wild_type *w_ptr = NULL;
+    struct loc grid;
+    int i;
+
+    for (i = 0; i < z_info->dungeon_max; i++)
+    {
+        struct wild_type *w = get_wt_info_at(&dungeons[i].wpos.grid);
+
+        if (w_ptr && (w->max_depth <= w_ptr->max_depth)) continue;
+        w_ptr = w;
+        loc_copy(&grid, &dungeons[i].wpos.grid);
+    }
+    if (!w_ptr) return;
+
+    for (i = 2; i <= NumPlayers; i += 2)
+    {
+        int depth = w_ptr->min_depth + i / 2 - 1 + (n / BENCH_LEVEL_PERIOD) * (BENCH_BOTS / 2);
+
+        if (depth >= w_ptr->max_depth) continue;
+        bench_change_level(i, &grid, depth, n);
+    }
+}
+
+
+/*
+ * Create the scripted players
+ */
+static int bench_create_bots(void)
+{
+    int i;
+
+    for (i = 0; i < BENCH_BOTS; i++)
+    {
+        char nick[NORMAL_WID];
+
+        strnfmt(nick, sizeof(nick), "Benchbot%d", i + 1);
+
+        if (Setup_bot_connection(nick, i % player_rmax(), i % player_cmax(), i % MAX_SEXES) == -1)
+            plog_fmt("Couldn't create bot %s", nick);
+    }
+
+    /* Don't let the bots die (same as toggling DM_INVULNERABLE) */
+    for (i = 1; i <= NumPlayers; i++)
+    {
+        struct player *p = player_get(i);
+
+        p->dm_flags |= DM_INVULNERABLE;
+        p->timed[TMD_INVULN] = -1;
+    }
+
+    return NumPlayers;
+}
+
+
+/*
+ * Queue a random walk command for every bot that doesn't have anything to do
+ */
+static void bench_script_bots(void)
+{
+    int i;
+
+    for (i = 1; i <= NumPlayers; i++)
+    {
+        struct player *p = player_get(i);
+        connection_t *connp = get_connection(p->conn);
+        int dir;
+
+        if (connp->state != CONN_PLAYING) continue;
+        if (connp->q.len > 0) continue;
+
+        /* Pick a direction (never 5) */
+        dir = randint1(8);
+        if (dir >= 5) dir++;
+
+        Packet_put_dir(&connp->q, PKT_WALK, dir);
+    }
+}
+
+
+/*
+ * RLE-encode a line of the screen of a bot (RLE_LARGE mode), using either the generic
+ * Packet_printf() or the fixed layout functions
+ */
+static int bench_rle_line(sockbuf_t *sbuf, cave_view_type *line, int cols, bool fixed)
+{
+    int i, x, b = 0;
+    char c;
+    u16b a, n;
+
+    for (i = 0; i < cols; i = x)
+    {
+        c = line[i].c;
+        a = line[i].a;
+
+        /* Count repetitions of this grid */
+        for (x = i + 1; (x < cols) && (line[x].c == c) && (line[x].a == a); x++) ;
+        n = x - i;
+
+        if (n >= 2)
+        {
+            a |= 0x8000;
+            if (fixed) Packet_put_cell_run(sbuf, c, a, n);
+            else Packet_printf(sbuf, "%c%hu%hu", (int)c, (unsigned)a, (unsigned)n);
+            b += 5;
+        }
+        else
+        {
+            if (fixed) Packet_put_cell(sbuf, c, a);
+            else Packet_printf(sbuf, "%c%hu", (int)c, (unsigned)a);
+            b += 3;
+        }
+    }
+
+    return b;
+}
+
+
+/*
+ * Encode the screens of all the bots
+ */
+static void bench_rle_screens(sockbuf_t *sbuf, bool fixed)
+{
+    int i, y;
+
+    Sockbuf_clear(sbuf);
+
+    for (i = 1; i <= NumPlayers; i++)
+    {
+        struct player *p = player_get(i);
+        int cols = p->screen_cols / p->tile_wid, rows = p->screen_rows / p->tile_hgt;
+
+        for (y = 0; y < rows; y++) bench_rle_line(sbuf, p->scr_info[y], cols, fixed);
+    }
+}
+
+
+/*
+ * Decode a stream of RLE-encoded grids, return the number of grids (or -1 on error)
+ */
+static long bench_rle_decode(sockbuf_t *sbuf, bool fixed, u32b *sum)
+{
+    long grids = 0;
+    char c;
+    u16b a, n;
+
+    sbuf->ptr = sbuf->buf;
+    while (sbuf->ptr < sbuf->buf + sbuf->len)
+    {
+        n = 1;
+        if ((fixed? Packet_get_cell(sbuf, &c, &a): Packet_scanf(sbuf, "%c%hu", &c, &a)) <= 0)
+            return -1;
+        if (a & 0x8000)
+        {
+            a &= ~0x8000;
+            if ((fixed? Packet_get_run_length(sbuf, &n): Packet_scanf(sbuf, "%hu", &n)) <= 0)
+                return -1;
+        }
+
+        *sum = *sum * 31 + (byte)c;
+        *sum = *sum * 31 + a;
+        *sum = *sum * 31 + n;
+        grids += n;
+    }
+
+    return grids;
+}
+
+
+/*
+ * Compare the generic packet functions with the fixed layout ones on the final screens
+ * of the bots
+ */
+static void bench_packets(void)
+{
+    sockbuf_t gen, fix;
+    int i, size = 0;
+    u64b start, t_gen, t_fix;
+    u32b sum_gen = 0, sum_fix = 0;
+    long grids_gen = 0, grids_fix = 0;
+
+    /* Worst case: 3 bytes per grid */
+    for (i = 1; i <= NumPlayers; i++)
+    {
+        struct player *p = player_get(i);
+
+        size += (p->screen_cols / p->tile_wid) * (p->screen_rows / p->tile_hgt) * 3;
+    }
+    Sockbuf_init(&gen, -1, size + 1, SOCKBUF_WRITE | SOCKBUF_READ | SOCKBUF_LOCK);
+    Sockbuf_init(&fix, -1, size + 1, SOCKBUF_WRITE | SOCKBUF_READ | SOCKBUF_LOCK);
+
+    /* Encode */
+    start = profile_ticks();
+    for (i = 0; i < BENCH_PACKET_PASSES; i++) bench_rle_screens(&gen, false);
+    t_gen = profile_ticks() - start;
+    start = profile_ticks();
+    for (i = 0; i < BENCH_PACKET_PASSES; i++) bench_rle_screens(&fix, true);
+    t_fix = profile_ticks() - start;
+
+    plog_fmt("Packet encoding: %d bytes x %d, Packet_printf %.3f ms, fixed layouts %.3f ms",
+        gen.len, BENCH_PACKET_PASSES, (double)t_gen / 1000000.0, (double)t_fix / 1000000.0);
+    if ((gen.len != fix.len) || memcmp(gen.buf, fix.buf, gen.len))
+        plog("  encoded streams differ!");
+
+    /* Decode */
+    start = profile_ticks();
+    for (i = 0; i < BENCH_PACKET_PASSES; i++) grids_gen = bench_rle_decode(&gen, false, &sum_gen);
+    t_gen = profile_ticks() - start;
+    start = profile_ticks();
+    for (i = 0; i < BENCH_PACKET_PASSES; i++) grids_fix = bench_rle_decode(&fix, true, &sum_fix);
+    t_fix = profile_ticks() - start;
+
+    plog_fmt("Packet decoding: %ld grids x %d, Packet_scanf %.3f ms, fixed layouts %.3f ms",
+        grids_gen, BENCH_PACKET_PASSES, (double)t_gen / 1000000.0, (double)t_fix / 1000000.0);
+    if ((grids_gen != grids_fix) || (sum_gen != sum_fix))
+        plog("  decoded streams differ!");
+
+    Sockbuf_cleanup(&gen);
+    Sockbuf_cleanup(&fix);
+}
+
+
+/*
+ * Litter the town with objects and build the object list of a bot standing there, from the
+ * list of known piles and from a scan of the whole level
+ */
+static void bench_objlist(void)
+{
+    struct player *p = NULL;
+    struct chunk *c;
+    object_list_t *list;
+    u64b start, t_piles, t_scan;
+    int i, tries, entries[2], objects[2];
+
+    for (i = 1; i <= NumPlayers; i++)
+    {
+        if (player_get(i)->wpos.depth == 0)
+        {
+            p = player_get(i);
+            break;
+        }
+    }
+    if (!p) return;
+    c = chunk_get(&p->wpos);
+
+    /* Drop the objects and let the bot see them */
+    for (i = 0, tries = 0; (i < BENCH_OBJECTS) && (tries < BENCH_OBJECTS * 100); tries++)
+    {
+        struct loc grid;
+
+        loc_init(&grid, randint0(c->width), randint0(c->height));
+        if (!square_in_bounds_fully(c, &grid) || !square_canputitem(c, &grid)) continue;
+
+        place_object(p, c, &grid, 30, false, false, ORIGIN_FLOOR, 0);
+        square_know_pile(p, c, &grid);
+        i++;
+    }
+
+    list = object_list_new();
+
+    /* Known piles */
+    start = profile_ticks();
+    for (i = 0; i < BENCH_OBJLIST_PASSES; i++)
+    {
+        object_list_reset(list);
+        object_list_collect(p, list);
+    }
+    t_piles = profile_ticks() - start;
+    entries[0] = list->distinct_entries;
+    objects[0] = list->total_objects[OBJECT_LIST_SECTION_LOS] +
+        list->total_objects[OBJECT_LIST_SECTION_NO_LOS];
+
+    /* Whole level (the DM sees the real objects, which the bot knows exactly) */
+    p->dm_flags |= DM_SEE_LEVEL;
+    start = profile_ticks();
+    for (i = 0; i < BENCH_OBJLIST_PASSES; i++)
+    {
+        object_list_reset(list);
+        object_list_collect(p, list);
+    }
+    t_scan = profile_ticks() - start;
+    p->dm_flags &= ~(DM_SEE_LEVEL);
+    entries[1] = list->distinct_entries;
+    objects[1] = list->total_objects[OBJECT_LIST_SECTION_LOS] +
+        list->total_objects[OBJECT_LIST_SECTION_NO_LOS];
+
+    plog_fmt("Object list: %d entries (%d objects, %d piles) x %d, known piles %.3f ms, "
+        "level scan %.3f ms", entries[0], objects[0], p->cave->piles_num, BENCH_OBJLIST_PASSES,
+        (double)t_piles / 1000000.0, (double)t_scan / 1000000.0);
+    if ((entries[0] != entries[1]) || (objects[0] != objects[1]))
+        plog("  lists differ!");
+
+    object_list_free(list);
+}
+
+
+/*
+ * Describe a set of random artifacts (name and level), regenerating them for each description
+ * as if there was no cache, then using the randart cache
+ */
+static void bench_randarts(void)
+{
+    struct player *p;
+    struct object **objs;
+    char (*names)[NORMAL_WID];
+    char buf[NORMAL_WID];
+    int *levels;
+    u64b start, t_cold, t_warm;
+    int i, pass, num = 0, tries, differ = 0;
+
+    if (!cfg_random_artifacts || !NumPlayers) return;
+    p = player_get(1);
+
+    objs = mem_zalloc(BENCH_RANDARTS * sizeof(struct object *));
+    names = mem_zalloc(BENCH_RANDARTS * sizeof(*names));
+    levels = mem_zalloc(BENCH_RANDARTS * sizeof(int));
+
+    /* Make the random artifacts */
+    for (tries = 0; (num < BENCH_RANDARTS) && (tries < BENCH_RANDARTS * 10); tries++)
+    {
+        struct artifact *a = &a_info[randint0(z_info->a_max)], *art;
+        s32b randart_seed = (randint0(0xFFFF) << 16) + randint0(0xFFFF);
+
+        if (!a->name || !a->tval) continue;
+        art = do_randart(randart_seed, a);
+        if (!art) continue;
+
+        objs[num] = object_new();
+        object_prep(p, objs[num], lookup_kind(art->tval, art->sval), art->alloc_min, RANDOMISE);
+        objs[num]->artifact = a;
+        objs[num]->randart_seed = randart_seed;
+        copy_artifact_data(objs[num], art);
+        object_set_base_known(p, objs[num]);
+        release_randart(art);
+        num++;
+    }
+
+    /* Regenerate everything */
+    start = profile_ticks();
+    for (i = 0; i < num; i++)
+    {
+        randart_cache_flush();
+        object_desc(p, names[i], sizeof(names[0]), objs[i], ODESC_PREFIX | ODESC_FULL |
+            ODESC_ARTIFACT);
+        randart_cache_flush();
+        levels[i] = get_artifact_level(objs[i]);
+    }
+    t_cold = profile_ticks() - start;
+
+    /* Use the cache (once to fill it) */
+    for (i = 0; i < num; i++)
+    {
+        object_desc(p, buf, sizeof(buf), objs[i], ODESC_PREFIX | ODESC_FULL | ODESC_ARTIFACT);
+        get_artifact_level(objs[i]);
+    }
+    start = profile_ticks();
+    for (pass = 0; pass < BENCH_RANDART_PASSES; pass++)
+    {
+        for (i = 0; i < num; i++)
+        {
+            object_desc(p, buf, sizeof(buf), objs[i], ODESC_PREFIX | ODESC_FULL | ODESC_ARTIFACT);
+            if (!streq(buf, names[i]) || (get_artifact_level(objs[i]) != levels[i])) differ++;
+        }
+    }
+    t_warm = profile_ticks() - start;
+
+    plog_fmt("Randarts: %d described, regenerated %.2f us each, cached %.2f us each", num,
+        num? (double)t_cold / 1000.0 / num: 0.0,
+        num? (double)t_warm / 1000.0 / num / BENCH_RANDART_PASSES: 0.0);
+    randart_cache_describe(buf, sizeof(buf));
+    plog_fmt("  %s", buf);
+    if (differ) plog_fmt("  %d descriptions differ!", differ);
+
+    for (i = 0; i < num; i++) object_delete(&objs[i]);
+    mem_free(objs);
+    mem_free(names);
+    mem_free(levels);
+}
+
+
+/*
+ * Create objects (with their known versions) like a level does, then free them in random order
+ */
+static void bench_objects(void)
+{
+    struct object **objs = mem_zalloc(BENCH_POOL_OBJECTS * sizeof(struct object *));
+    char buf[MSG_LEN];
+    u64b start;
+    int i, pass;
+
+    start = profile_ticks();
+    for (pass = 0; pass < BENCH_POOL_PASSES; pass++)
+    {
+        for (i = 0; i < BENCH_POOL_OBJECTS; i++)
+        {
+            objs[i] = object_new();
+            objs[i]->known = object_new();
+        }
+        for (i = BENCH_POOL_OBJECTS - 1; i > 0; i--)
+        {
+            int j = randint0(i + 1);
+            struct object *obj = objs[i];
+
+            objs[i] = objs[j];
+            objs[j] = obj;
+        }
+        for (i = 0; i < BENCH_POOL_OBJECTS; i++) object_delete(&objs[i]);
+    }
+
+    plog_fmt("Objects: %d created and freed x %d in %.3f ms", BENCH_POOL_OBJECTS * 2,
+        BENCH_POOL_PASSES, (double)(profile_ticks() - start) / 1000000.0);
+    object_pool_describe(buf, sizeof(buf));
+    plog_fmt("  %s", buf);
+
+    /* As when a level is freed */
+    object_pool_trim();
+    object_pool_describe(buf, sizeof(buf));
+    plog_fmt("  after trim: %s", buf);
+
+    mem_free(objs);
+}
+
+
+/*
+ * Create, reload and log into a large number of accounts, using a scratch account file
+ */
+static void bench_accounts(void)
+{
+    char filename[MSG_LEN];
+    char name[NORMAL_WID], pass[NORMAL_WID], line[MSG_LEN];
+    u64b start, t_create, t_load, t_login, t_scan;
+    u32b i, bad = 0;
+    ang_file *fh;
+
+    path_build(filename, sizeof(filename), ANGBAND_DIR_SAVE, "account.bench");
+    file_delete(filename);
+    if (!accounts_load(filename)) return;
+
+    /* Create */
+    start = profile_ticks();
+    for (i = 0; i < BENCH_ACCOUNTS; i++)
+    {
+        strnfmt(name, sizeof(name), "Bench%lu", (unsigned long)i);
+        strnfmt(pass, sizeof(pass), "pass%lu", (unsigned long)i);
+        if (get_account(name, pass) != i + 1) bad++;
+    }
+    t_create = profile_ticks() - start;
+
+    /* Reload */
+    start = profile_ticks();
+    accounts_load(filename);
+    t_load = profile_ticks() - start;
+
+    /* Log in (good and bad passwords) */
+    start = profile_ticks();
+    for (i = 0; i < BENCH_ACCOUNTS; i++)
+    {
+        strnfmt(name, sizeof(name), "BENCH%lu", (unsigned long)i);
+        strnfmt(pass, sizeof(pass), "pass%lu", (unsigned long)i);
+        if (get_account(name, pass) != i + 1) bad++;
+        if (get_account(name, "wrong")) bad++;
+    }
+    t_login = profile_ticks() - start;
+
+    /* What a login to the last account used to cost: a scan of the whole file */
+    start = profile_ticks();
+    fh = file_open(filename, MODE_READ, FTYPE_TEXT);
+    if (fh)
+    {
+        while (file_getl(fh, line, sizeof(line))) my_stricmp(line, name);
+        file_close(fh);
+    }
+    t_scan = profile_ticks() - start;
+
+    plog_fmt("Accounts: %d created in %.3f ms, reloaded in %.3f ms, %d logins in %.3f ms "
+        "(%.2f us each), file scan %.3f ms", BENCH_ACCOUNTS, (double)t_create / 1000000.0,
+        (double)t_load / 1000000.0, BENCH_ACCOUNTS * 2, (double)t_login / 1000000.0,
+        (double)t_login / 1000.0 / (BENCH_ACCOUNTS * 2), (double)t_scan / 1000000.0);
+    if (bad) plog_fmt("  %lu wrong account IDs!", (unsigned long)bad);
+
+    accounts_free();
+    file_delete(filename);
+}
+
+
+/*
+ * Log a line of the frame profile
+ */
+static void bench_plog(void *data, const char *line)
+{
+    plog(line);
+}
+
+
+/*
+ * Run the benchmark and quit
+ */
+void run_bench(void)
+{
+    u32b n;
+    u64b start, elapsed;
+    int i, bots;
+
+    bots = bench_create_bots();
+    if (!bots) quit("Couldn't create any bot");
+
+    plog_fmt("Running %lu game turns with %d bots...", (unsigned long)bench_turns, bots);
+
+    memset(bench_total, 0, sizeof(bench_total));
+    memset(bench_worst, 0, sizeof(bench_worst));
+    bench_bytes = 0;
+    memset(bench_map_total, 0, sizeof(bench_map_total));
+    bench_map_cells = bench_map_bytes = bench_map_single = bench_map_worst = 0;
+    memset(bench_limbo_turn, 0, sizeof(bench_limbo_turn));
+    bench_limbo_count = bench_limbo_turns = bench_limbo_worst = 0;
+    profile_reset();
+
+    start = profile_ticks();
+    for (n = 0; n < bench_turns; n++)
+    {
+        if (!(n % BENCH_LEVEL_PERIOD)) bench_level_wave(n);
+        bench_script_bots();
+        run_game_loop();
+        bench_limbo_check(n);
+        bench_map_turn();
+    }
+    elapsed = profile_ticks() - start;
+
+    /* Net_output() is called from post_turn_game_loop(): report it separately */
+    bench_total[BENCH_POST_TURN] -= bench_total[BENCH_NET_OUTPUT];
+
+    plog_fmt("Benchmark: %lu turns in %.3f ms (%.2f us/turn, %lu players)",
+        (unsigned long)bench_turns, (double)elapsed / 1000000.0,
+        (double)elapsed / 1000.0 / bench_turns, (unsigned long)NumPlayers);
+    for (i = 0; i < BENCH_MAX; i++)
+    {
+        plog_fmt("  %-20s total %10.3f ms, avg %9.2f us, worst %9.2f us",
+            bench_phase_name[i], (double)bench_total[i] / 1000000.0,
+            (double)bench_total[i] / 1000.0 / bench_turns, (double)bench_worst[i] / 1000.0);
+    }
+    plog_fmt("  %lu bytes sent", (unsigned long)bench_bytes);
+    plog_fmt("  %lu map grids sent in %lu bytes (%lu bytes as single grids)",
+        (unsigned long)bench_map_total[0], (unsigned long)bench_map_total[1],
+        (unsigned long)bench_map_total[2]);
+    plog_fmt("  map updates: avg %.1f bytes/turn, worst %ld bytes",
+        (double)bench_map_total[1] / bench_turns, bench_map_worst);
+    if (bench_limbo_count)
+    {
+        /* Turns run back to back here: convert them to real time at the configured rate */
+        plog_fmt("  %ld level changes: limbo avg %.2f turns (%.1f ms at %d fps), worst %ld turns (%.1f ms)",
+            bench_limbo_count, (double)bench_limbo_turns / bench_limbo_count,
+            (double)bench_limbo_turns * 1000.0 / bench_limbo_count / cfg_fps, cfg_fps,
+            bench_limbo_worst, (double)bench_limbo_worst * 1000.0 / cfg_fps);
+    }
+
+    /* Detailed breakdown */
+    profile_dump(bench_plog, NULL);
+
+    /* Packet encoding/decoding */
+    bench_packets();
+
+    /* Object list */
+    bench_objlist();
+
+    /* Random artifacts */
+    bench_randarts();
+
+    /* Object pool */
+    bench_objects();
+
+    /* Account store */
+    bench_accounts();
+
+    /* Quit without saving anything */
+    quit(NULL);
+}
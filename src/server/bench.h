@@ -0,0 +1,32 @@
+/*
+ * File: bench.h
+ * Purpose: Headless benchmark mode
+ */
+
+#ifndef INCLUDED_BENCH_H
+#define INCLUDED_BENCH_H
+
+/* Fixed RNG seed used in benchmark mode */
+#define BENCH_SEED  0x50574D41
+
+/*
+ * Timed phases of a game turn
+ */
+enum
+{
+    BENCH_PRE_TURN = 0,
+    BENCH_PROCESS_PLAYER,
+    BENCH_POST_TURN,
+    BENCH_NET_OUTPUT,
+
+    BENCH_MAX
+};
+
+extern u32b bench_turns;
+
+extern void bench_add(int phase, u64b start);
+extern void bench_sent(long len);
+extern void bench_map(int cells, int bytes, int single);
+extern void run_bench(void);
+
+#endif /* INCLUDED_BENCH_H */
@@ -222,15 +222,16 @@ void square_note_spot_aux(struct player *p, struct chunk *c, struct loc *grid)
 
 void square_note_spot(struct chunk *c, struct loc *grid)
 {
-    int i;
+    int i, n;
 
     /* Paranoia */
     if (!c) return;
 
-    /* Check everyone */
-    for (i = 1; i <= NumPlayers; i++)
+    /* Check everyone on the level */
+    n = cave_player_count(c);
+    for (i = 0; i < n; i++)
     {
-        struct player *p = player_get(i);
+        struct player *p = cave_player(c, i);
 
         /* Memorize interesting viewable object/features in the given grid for that player */
         square_note_spot_aux(p, c, grid);
@@ -274,8 +275,8 @@ void square_light_spot_aux(struct player *p, struct chunk *cv, struct loc *grid)
             p->trn_info[disp.y][disp.x].c = tc;
             p->trn_info[disp.y][disp.x].a = ta;
 
-            /* Tell client to redraw this grid */
-            Send_char(p, &disp, a, c, ta, tc);
+            /* Tell client to redraw this grid (at the end of the turn) */
+            Send_char_later(p, &disp);
         }
     }
 }
@@ -283,18 +284,16 @@ void square_light_spot_aux(struct player *p, struct chunk *cv, struct loc *grid)
 
 void square_light_spot(struct chunk *c, struct loc *grid)
 {
-    int i;
+    int i, n;
 
     /* Paranoia */
     if (!c) return;
 
-    /* Check everyone */
-    for (i = 1; i <= NumPlayers; i++)
+    /* Check everyone on the level */
+    n = cave_player_count(c);
+    for (i = 0; i < n; i++)
     {
-        struct player *p = player_get(i);
-
-        /* If he's not here, skip him */
-        if (!wpos_eq(&p->wpos, &c->wpos)) continue;
+        struct player *p = cave_player(c, i);
 
         /* Actually light that spot for that player */
         square_light_spot_aux(p, c, grid);
@@ -363,15 +362,13 @@ static void cave_light(struct player *p, struct chunk *c, struct point_set *ps)
  */
 static void cave_unlight(struct chunk *c, struct point_set *ps)
 {
-    int i, j;
+    int i, j, n;
 
-    /* Check everyone */
-    for (j = 1; j <= NumPlayers; j++)
+    /* Check everyone on the level */
+    n = cave_player_count(c);
+    for (j = 0; j < n; j++)
     {
-        struct player *p = player_get(j);
-
-        /* If he's not here, skip him */
-        if (!wpos_eq(&p->wpos, &c->wpos)) continue;
+        struct player *p = cave_player(c, j);
 
         /* Apply flag changes */
         for (i = 0; i < ps->n; i++)
@@ -693,18 +690,16 @@ void cave_illuminate(struct player *p, struct chunk *c, bool daytime)
 
 void square_forget_all(struct chunk *c, struct loc *grid)
 {
-    int i;
+    int i, n;
 
     /* Paranoia */
     if (!c) return;
 
-    /* Check everyone */
-    for (i = 1; i <= NumPlayers; i++)
+    /* Check everyone on the level */
+    n = cave_player_count(c);
+    for (i = 0; i < n; i++)
     {
-        struct player *p = player_get(i);
-
-        /* If he's not here, skip him */
-        if (!wpos_eq(&p->wpos, &c->wpos)) continue;
+        struct player *p = cave_player(c, i);
 
         sqinfo_off(square_p(p, grid)->info, SQUARE_SEEN);
         square_forget(p, grid);
@@ -715,18 +710,16 @@ void square_forget_all(struct chunk *c, struct loc *grid)
 
 void square_forget_pile_all(struct chunk *c, struct loc *grid)
 {
-    int i;
+    int i, n;
 
     /* Paranoia */
     if (!c) return;
 
-    /* Check everyone */
-    for (i = 1; i <= NumPlayers; i++)
+    /* Check everyone on the level */
+    n = cave_player_count(c);
+    for (i = 0; i < n; i++)
     {
-        struct player *p = player_get(i);
-
-        /* If he's not here, skip him */
-        if (!wpos_eq(&p->wpos, &c->wpos)) continue;
+        struct player *p = cave_player(c, i);
 
         square_forget_pile(p, grid);
     }
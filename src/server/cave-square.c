@@ -267,7 +267,7 @@ bool feat_ismetamap(int feat)
  * SQUARE FEATURE PREDICATES
  *
  * These functions are used to figure out what kind of square something is,
- * via c->squares[y][x].feat (preferably accessed via square(c, grid)).
+ * via square(c, grid)->feat.
  * All direct testing of square(c, grid).feat should be rewritten
  * in terms of these functions.
  *
@@ -1330,14 +1330,14 @@ bool square_isbelievedwall(struct player *p, struct chunk *c, struct loc *grid)
 struct square *square(struct chunk *c, struct loc *grid)
 {
     my_assert(square_in_bounds(c, grid));
-    return &c->squares[grid->y][grid->x];
+    return &c->squares[grid->y * c->width + grid->x];
 }
 
 
 struct player_square *square_p(struct player *p, struct loc *grid)
 {
     my_assert(player_square_in_bounds(p, grid));
-    return &p->cave->squares[grid->y][grid->x];
+    return &p->cave->squares[grid->y * p->cave->width + grid->x];
 }
 
 
@@ -1487,7 +1487,8 @@ void square_sense_pile(struct player *p, struct chunk *c, struct loc *grid)
 
 static bool object_equals(const struct object *obj1, const struct object *obj2)
 {
-    struct object *test;
+    struct object test_body;
+    struct object *test = &test_body;
 
     /* Objects are strictly equal */
     if (obj1 == obj2) return true;
@@ -1496,7 +1497,6 @@ static bool object_equals(const struct object *obj1, const struct object *obj2)
     if (!(obj1 && obj2)) return false;
 
     /* Make a writable identical copy of the second object */
-    test = object_new();
     memcpy(test, obj2, sizeof(struct object));
 
     /* Make prev and next strictly equal since they are irrelevant */
@@ -1504,31 +1504,19 @@ static bool object_equals(const struct object *obj1, const struct object *obj2)
     test->next = obj1->next;
 
     /* Known part must be equal */
-    if (!object_equals(obj1->known, test->known))
-    {
-        mem_free(test);
-        return false;
-    }
+    if (!object_equals(obj1->known, test->known)) return false;
 
     /* Make known strictly equal since they are now irrelevant */
     test->known = obj1->known;
 
     /* Brands must be equal */
-    if (!brands_are_equal(obj1, test))
-    {
-        mem_free(test);
-        return false;
-    }
+    if (!brands_are_equal(obj1, test)) return false;
 
     /* Make brands strictly equal since they are now irrelevant */
     test->brands = obj1->brands;
 
     /* Slays must be equal */
-    if (!slays_are_equal(obj1, test))
-    {
-        mem_free(test);
-        return false;
-    }
+    if (!slays_are_equal(obj1, test)) return false;
 
     /* Make slays strictly equal since they are now irrelevant */
     test->slays = obj1->slays;
@@ -1537,14 +1525,9 @@ static bool object_equals(const struct object *obj1, const struct object *obj2)
     test->attr = obj1->attr;
 
     /* All other fields must be equal */
-    if (memcmp(obj1, test, sizeof(struct object)) != 0)
-    {
-        mem_free(test);
-        return false;
-    }
+    if (memcmp(obj1, test, sizeof(struct object)) != 0) return false;
 
     /* Success */
-    mem_free(test);
     return true;
 }
 
@@ -1564,6 +1547,8 @@ static void square_update_pile(struct player *p, struct chunk *c, struct loc *gr
         /* Attach it to the current floor pile */
         pile_insert_end(&square_p(p, grid)->obj, new_obj);
     }
+
+    square_track_pile(p, grid);
 }
 
 
@@ -1611,6 +1596,17 @@ void square_know_pile(struct player *p, struct chunk *c, struct loc *grid)
 void square_forget_pile(struct player *p, struct loc *grid)
 {
     struct object *current, *next;
+    u16b pos = square_p(p, grid)->pile;
+
+    /* Remove the grid from the list of known piles */
+    if (pos)
+    {
+        struct loc *last = &p->cave->piles[--p->cave->piles_num];
+
+        loc_copy(&p->cave->piles[pos - 1], last);
+        square_p(p, last)->pile = pos;
+        square_p(p, grid)->pile = 0;
+    }
 
     current = square_p(p, grid)->obj;
     while (current)
@@ -1627,6 +1623,56 @@ void square_forget_pile(struct player *p, struct loc *grid)
 }
 
 
+/*
+ * Add a grid to the list of known piles once the player knows an object there
+ */
+void square_track_pile(struct player *p, struct loc *grid)
+{
+    struct player_square *square = square_p(p, grid);
+
+    if (!square->obj || square->pile) return;
+
+    if (p->cave->piles_num == p->cave->piles_max)
+    {
+        p->cave->piles_max = (p->cave->piles_max? p->cave->piles_max * 2: 64);
+        p->cave->piles = mem_realloc(p->cave->piles, p->cave->piles_max * sizeof(struct loc));
+    }
+
+    loc_copy(&p->cave->piles[p->cave->piles_num++], grid);
+    square->pile = (u16b)p->cave->piles_num;
+}
+
+
+/*
+ * Put the list of known piles back in grid order (it only gets shuffled a little between
+ * two calls, so a simple insertion sort will do)
+ */
+void square_sort_piles(struct player *p)
+{
+    struct loc *piles = p->cave->piles;
+    int i, j;
+    bool moved = false;
+
+    for (i = 1; i < p->cave->piles_num; i++)
+    {
+        struct loc grid;
+
+        loc_copy(&grid, &piles[i]);
+        for (j = i; (j > 0) && ((piles[j - 1].y > grid.y) ||
+            ((piles[j - 1].y == grid.y) && (piles[j - 1].x > grid.x))); j--)
+        {
+            loc_copy(&piles[j], &piles[j - 1]);
+            moved = true;
+        }
+        loc_copy(&piles[j], &grid);
+    }
+
+    if (!moved) return;
+
+    for (i = 0; i < p->cave->piles_num; i++) square_p(p, &piles[i])->pile = (u16b)(i + 1);
+}
+
+
 struct object *square_known_pile(struct player *p, struct chunk *c, struct loc *grid)
 {
     /* Hack -- DM has full knowledge */
@@ -1681,6 +1727,9 @@ void square_set_feat(struct chunk *c, struct loc *grid, int feat)
     if (current_feat) c->feat_count[current_feat]--;
     if (feat) c->feat_count[feat]++;
 
+    /* Sound propagation changes */
+    if (feat_is_no_flow(current_feat) != feat_is_no_flow(feat)) cave_new_flow_stamp(c);
+
     /* Make the change */
     square(c, grid)->feat = feat;
 
@@ -452,24 +452,45 @@ bool los(struct chunk *c, struct loc *grid1, struct loc *grid2)
  */
 
 
-static void mark_wasseen(struct player *p, struct chunk *c)
+/*
+ * Get the area that can hold viewable grids: since every grid in view (or lit by another
+ * light source) is within "max_sight" of the player, this is a box around the player.
+ */
+static void view_area(struct player *p, struct chunk *c, struct loc *begin, struct loc *end)
 {
-    struct loc begin, end;
-    struct loc_iterator iter;
+    loc_init(begin, MAX(p->grid.x - z_info->max_sight, 0),
+        MAX(p->grid.y - z_info->max_sight, 0));
+    loc_init(end, MIN(p->grid.x + z_info->max_sight + 1, c->width),
+        MIN(p->grid.y + z_info->max_sight + 1, c->height));
+}
 
-    loc_init(&begin, 0, 0);
-    loc_init(&end, c->width, c->height);
-    loc_iterator_first(&iter, &begin, &end);
+
+/*
+ * Get the area that held the viewable grids after the last update
+ */
+static void last_view_area(struct player *p, struct chunk *c, struct loc *begin,
+    struct loc *end)
+{
+    loc_copy(begin, &p->cave->view_begin);
+    loc_init(end, MIN(p->cave->view_end.x, c->width), MIN(p->cave->view_end.y, c->height));
+}
+
+
+static void mark_wasseen(struct player *p, struct chunk *c, struct loc *begin, struct loc *end)
+{
+    struct loc grid;
 
     /* Save the old "view" grids for later */
-    do
+    for (grid.y = begin->y; grid.y < end->y; grid.y++)
     {
-        if (square_isseen(p, &iter.cur))
-            sqinfo_on(square(c, &iter.cur)->info, SQUARE_WASSEEN);
-        sqinfo_off(square_p(p, &iter.cur)->info, SQUARE_VIEW);
-        sqinfo_off(square_p(p, &iter.cur)->info, SQUARE_SEEN);
+        for (grid.x = begin->x; grid.x < end->x; grid.x++)
+        {
+            if (square_isseen(p, &grid))
+                sqinfo_on(square(c, &grid)->info, SQUARE_WASSEEN);
+            sqinfo_off(square_p(p, &grid)->info, SQUARE_VIEW);
+            sqinfo_off(square_p(p, &grid)->info, SQUARE_SEEN);
+        }
     }
-    while (loc_iterator_next_strict(&iter));
 }
 
 
@@ -606,6 +627,57 @@ static void update_one(struct player *p, struct chunk *c, struct loc *grid)
 }
 
 
+/*
+ * Update the grids of a row between x1 and x2 (excluded)
+ */
+static void update_row(struct player *p, struct chunk *c, int y, int x1, int x2)
+{
+    struct loc grid;
+
+    loc_init(&grid, x1, y);
+    for (; grid.x < x2; grid.x++) update_one(p, c, &grid);
+}
+
+
+/*
+ * Update the grids of the old and new view areas, row by row and without visiting a grid
+ * twice, so that grids are processed in the same order as a scan of the whole level.
+ */
+static void update_areas(struct player *p, struct chunk *c, struct loc *old_begin,
+    struct loc *old_end, struct loc *begin, struct loc *end)
+{
+    int y;
+
+    for (y = MIN(old_begin->y, begin->y); y < MAX(old_end->y, end->y); y++)
+    {
+        bool in_old = ((y >= old_begin->y) && (y < old_end->y) && (old_begin->x < old_end->x));
+        bool in_new = ((y >= begin->y) && (y < end->y) && (begin->x < end->x));
+
+        /* Both areas overlap on this row: merge them */
+        if (in_old && in_new && (old_begin->x <= end->x) && (begin->x <= old_end->x))
+            update_row(p, c, y, MIN(old_begin->x, begin->x), MAX(old_end->x, end->x));
+
+        /* Disjoint areas: left one first */
+        else if (in_old && in_new)
+        {
+            if (old_begin->x < begin->x)
+            {
+                update_row(p, c, y, old_begin->x, old_end->x);
+                update_row(p, c, y, begin->x, end->x);
+            }
+            else
+            {
+                update_row(p, c, y, begin->x, end->x);
+                update_row(p, c, y, old_begin->x, old_end->x);
+            }
+        }
+
+        else if (in_old) update_row(p, c, y, old_begin->x, old_end->x);
+        else if (in_new) update_row(p, c, y, begin->x, end->x);
+    }
+}
+
+
 static void become_viewable(struct player *p, struct chunk *c, struct loc *grid, bool lit)
 {
     if (square_isview(p, grid)) return;
@@ -723,14 +795,17 @@ static void update_view_one(struct player *p, struct chunk *c, struct loc *grid,
 
 /*
  * Calculate the complete field of view.
+ *
+ * Only the grids within "max_sight" of the player are considered, and only the grids that
+ * were viewable after the last update or may be viewable now are updated.
  */
 void update_view(struct player *p, struct chunk *c)
 {
     int radius;
-    struct loc begin, end;
-    struct loc_iterator iter;
+    struct loc begin, end, old_begin, old_end, grid;
 
-    mark_wasseen(p, c);
+    last_view_area(p, c, &old_begin, &old_end);
+    mark_wasseen(p, c, &old_begin, &old_end);
 
     /* Extract "radius" value */
     radius = p->state.cur_light;
@@ -747,24 +822,20 @@ void update_view(struct player *p, struct chunk *c)
     if ((radius > 0) || square_isglow(c, &p->grid))
         sqinfo_on(square_p(p, &p->grid)->info, SQUARE_SEEN);
 
-    loc_init(&begin, 0, 0);
-    loc_init(&end, c->width, c->height);
-    loc_iterator_first(&iter, &begin, &end);
+    view_area(p, c, &begin, &end);
 
     /* View squares we have LOS to */
-    do
+    for (grid.y = begin.y; grid.y < end.y; grid.y++)
     {
-        update_view_one(p, c, &iter.cur, radius);
+        for (grid.x = begin.x; grid.x < end.x; grid.x++)
+            update_view_one(p, c, &grid, radius);
     }
-    while (loc_iterator_next_strict(&iter));
 
-    loc_iterator_first(&iter, &begin, &end);
+    update_areas(p, c, &old_begin, &old_end, &begin, &end);
 
-    do
-    {
-        update_one(p, c, &iter.cur);
-    }
-    while (loc_iterator_next_strict(&iter));
+    /* Remember the area for the next update */
+    loc_copy(&p->cave->view_begin, &begin);
+    loc_copy(&p->cave->view_end, &end);
 }
 
 
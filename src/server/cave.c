@@ -383,12 +383,26 @@ void set_terrain(void)
 }
 
 
+/*
+ * Give a new flow stamp to a level, invalidating the noise fields computed on it
+ */
+void cave_new_flow_stamp(struct chunk *c)
+{
+    static u32b flow_stamp = 0;
+
+    /* Never use 0, which means "no noise field" */
+    flow_stamp++;
+    if (!flow_stamp) flow_stamp++;
+
+    c->flow_stamp = flow_stamp;
+}
+
+
 /*
  * Allocate a new chunk of the world
  */
 struct chunk *cave_new(int height, int width)
 {
-    struct loc grid;
     struct chunk *c = mem_zalloc(sizeof(*c));
 
     c->height = height;
@@ -396,13 +410,7 @@ struct chunk *cave_new(int height, int width)
 
     c->feat_count = mem_zalloc(z_info->f_max * sizeof(int));
 
-    c->squares = mem_zalloc(c->height * sizeof(struct square*));
-    for (grid.y = 0; grid.y < c->height; grid.y++)
-    {
-        c->squares[grid.y] = mem_zalloc(c->width * sizeof(struct square));
-        for (grid.x = 0; grid.x < c->width; grid.x++)
-            square(c, &grid)->info = mem_zalloc(SQUARE_SIZE * sizeof(bitflag));
-    }
+    c->squares = mem_zalloc(c->height * c->width * sizeof(struct square));
 
     c->monsters = mem_zalloc(z_info->level_monster_max * sizeof(struct monster));
     c->mon_max = 1;
@@ -412,6 +420,9 @@ struct chunk *cave_new(int height, int width)
     c->o_gen = mem_zalloc(MAX_OBJECTS * sizeof(bool));
     c->join = mem_zalloc(sizeof(struct connector));
 
+    c->active_idx = -1;
+    cave_new_flow_stamp(c);
+
     return c;
 }
 
@@ -427,13 +438,11 @@ void cave_free(struct chunk *c)
     {
         for (grid.x = 0; grid.x < c->width; grid.x++)
         {
-            mem_free(square(c, &grid)->info);
             if (square(c, &grid)->trap)
                 square_free_trap(c, &grid);
             if (square(c, &grid)->obj)
                 object_pile_free(square(c, &grid)->obj);
         }
-        mem_free(c->squares[grid.y]);
     }
     mem_free(c->squares);
 
@@ -442,7 +451,11 @@ void cave_free(struct chunk *c)
     mem_free(c->monster_groups);
     mem_free(c->o_gen);
     mem_free(c->join);
+    mem_free(c->players);
     mem_free(c);
+
+    /* Give the memory used by the objects of the level back */
+    object_pool_trim();
 }
 
 
@@ -518,6 +531,100 @@ int cave_monster_count(struct chunk *c)
 }
 
 
+/*
+ * Players on a level.
+ *
+ * Every allocated level keeps the list of the players whose position is on that level,
+ * sorted by player index: going through it gives the same players in the same order as
+ * going through the whole player list and skipping the players on other levels. Players
+ * changing level are not on any level until they are placed on the new one (their known
+ * map is still the one of the old level). Players enter and leave levels much less often
+ * than these lists are used, so all of them are rebuilt in one pass over the player list
+ * the first time they are needed after a change.
+ */
+static bool cave_players_valid;
+
+
+/*
+ * Invalidate the lists of players on each level (a player has changed level, or has
+ * entered or left the game).
+ */
+void cave_players_changed(void)
+{
+    cave_players_valid = false;
+}
+
+
+static void cave_add_player(struct chunk *c, struct player *p)
+{
+    /* Grow the list if needed */
+    if (c->player_num == c->player_max)
+    {
+        c->player_max = (c->player_max? c->player_max * 2: 8);
+        c->players = mem_realloc(c->players, c->player_max * sizeof(struct player *));
+    }
+
+    c->players[c->player_num++] = p;
+}
+
+
+/*
+ * The number of players on the level.
+ */
+int cave_player_count(struct chunk *c)
+{
+    int i;
+
+    /* Levels not in the list of allocated levels (being generated or cached) */
+    if (c->active_idx == -1)
+    {
+        c->player_num = 0;
+        for (i = 1; i <= NumPlayers; i++)
+        {
+            struct player *p = player_get(i);
+
+            if (!p->upkeep->limbo && wpos_eq(&p->wpos, &c->wpos)) cave_add_player(c, p);
+        }
+
+        return c->player_num;
+    }
+
+    /* Rebuild all the lists */
+    if (!cave_players_valid)
+    {
+        for (i = 0; i < chunk_list_count(); i++) chunk_list_at(i)->player_num = 0;
+
+        for (i = 1; i <= NumPlayers; i++)
+        {
+            struct player *p = player_get(i);
+            struct chunk *pc;
+
+            if (p->upkeep->limbo) continue;
+
+            pc = chunk_get(&p->wpos);
+            if (pc) cave_add_player(pc, p);
+        }
+
+        cave_players_valid = true;
+    }
+
+    return c->player_num;
+}
+
+
+/*
+ * Get a player on the level by its index in the list (cave_player_count() must be called
+ * first).
+ */
+struct player *cave_player(struct chunk *c, int idx)
+{
+    /* Index MUST be valid */
+    my_assert((idx >= 0) && (idx < c->player_num));
+
+    return c->players[idx];
+}
+
+
 /*
  * Return the number of doors/traps around (or under) the character.
  */
@@ -635,6 +742,9 @@ void display_fullmap(struct player *p)
     struct loc grid;
     struct chunk *cv = chunk_get(&p->wpos);
 
+    /* Send the pending changes of the map (scr_info is used as scratch space below) */
+    Send_dirty_chars(p);
+
     /* Dump the map */
     for (grid.y = 0; grid.y < z_info->dungeon_hgt; grid.y++)
     {
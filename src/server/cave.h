@@ -82,7 +82,7 @@ struct grid_data
 struct square
 {
     u16b feat;
-    bitflag *info;
+    bitflag info[SQUARE_SIZE];
     s16b mon;
     struct object *obj;
     struct trap *trap;
@@ -105,7 +105,7 @@ struct chunk
     int width;
     int *feat_count;
 
-    struct square **squares;
+    struct square *squares; /* All the grids, row by row, in a single block */
     struct loc decoy;
 
     struct monster *monsters;
@@ -124,6 +124,13 @@ struct chunk
 
     bool light_level;
     bool gen_hack;
+
+    int active_idx;     /* Index in the list of allocated levels (-1 if not allocated) */
+    u32b flow_stamp;    /* Changed every time sound propagation through the level changes */
+
+    struct player **players;    /* Players on the level, by player index (see cave_player()) */
+    int player_num;
+    int player_max;
 };
 
 /*
@@ -231,12 +238,16 @@ extern int motion_dir(struct loc *start, struct loc *finish);
 extern void next_grid(struct loc *next, struct loc *grid, int dir);
 extern int lookup_feat(const char *name);
 extern void set_terrain(void);
+extern void cave_new_flow_stamp(struct chunk *c);
 extern struct chunk *cave_new(int height, int width);
 extern void cave_free(struct chunk *c);
 extern bool scatter(struct chunk *c, struct loc *place, struct loc *grid, int d, bool need_los);
 extern struct monster *cave_monster(struct chunk *c, int idx);
 extern int cave_monster_max(struct chunk *c);
 extern int cave_monster_count(struct chunk *c);
+extern void cave_players_changed(void);
+extern int cave_player_count(struct chunk *c);
+extern struct player *cave_player(struct chunk *c, int idx);
 extern int count_feats(struct player *p, struct chunk *c, struct loc *grid,
     bool (*test)(struct chunk *c, struct loc *grid), bool under);
 extern struct loc *cave_find_decoy(struct chunk *c);
@@ -413,6 +424,8 @@ extern void square_excise_pile(struct chunk *c, struct loc *grid);
 extern void square_sense_pile(struct player *p, struct chunk *c, struct loc *grid);
 extern void square_know_pile(struct player *p, struct chunk *c, struct loc *grid);
 extern void square_forget_pile(struct player *p, struct loc *grid);
+extern void square_track_pile(struct player *p, struct loc *grid);
+extern void square_sort_piles(struct player *p);
 extern struct object *square_known_pile(struct player *p, struct chunk *c, struct loc *grid);
 extern int square_num_walls_adjacent(struct chunk *c, struct loc *grid);
 extern void square_set_feat(struct chunk *c, struct loc *grid, int feat);
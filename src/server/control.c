@@ -20,8 +20,6 @@
 #include "s-angband.h"
 
 
-#define CONSOLE_AUTH    1
-#define CONSOLE_LISTEN  0
 #define CONSOLE_WRITE   true
 #define CONSOLE_READ    false
 
@@ -49,6 +47,7 @@ static void console_reload(int ind, char *mod);
 static void console_shutdown(int ind, char *dummy);
 static void console_wrath(int ind, char *name);
 static void console_help(int ind, char *name);
+static void console_profile(int ind, char *mode);
 
 
 static console_command_ops console_commands[] =
@@ -63,6 +62,7 @@ static console_command_ops console_commands[] =
     {"reload", console_reload, 1, "config|news\nReload mangband.cfg or news.txt"},
     {"whois", console_whois, 1, "PLAYERNAME\nDetailed player information"},
     {"rngtest", console_rng_test, 0, "\nPerform RNG test"},
+    {"profile", console_profile, 0, "[reset|listen|quiet]\nShow or clear frame timings"},
     {"debug", console_debug, 0, "\nUnused"}
 };
 
@@ -180,7 +180,7 @@ static void console_read(int read_fd, int ind)
     char terminator = '\n';
     char *params;
     int i, j;
-    bool found = FALSE;
+    bool found = false;
 
     /* Get the password if not authenticated */
     if (!Conn_get_console_setting(ind, CONSOLE_AUTH))
@@ -235,7 +235,7 @@ static void console_read(int read_fd, int ind)
         if (!strncmp(buf, console_commands[i].name,
             (j = strlen(console_commands[i].name))) && (buflen <= j || buf[j] == ' '))
         {
-            found = TRUE;
+            found = true;
 
             if ((params == NULL) && (console_commands[i].min_arguments > 0))
             {
@@ -258,14 +258,16 @@ static void console_read(int read_fd, int ind)
  */
 void console_print(char *msg, int chan)
 {
-    int i;
+    int k;
     sockbuf_t *console_buf_w;
     char terminator = '\n';
     byte *chan_ptr;
     bool hint;
 
-    for (i = 0; i < MAX_PLAYERS; i++)
+    for (k = 0; k < Conn_active_num(); k++)
     {
+        int i = Conn_active(k);
+
         if (Conn_is_alive(i))
         {
             chan_ptr = Conn_get_console_channels(i);
@@ -378,6 +380,7 @@ static void console_whois(int ind, char *name)
     char *entry;
     sockbuf_t *console_buf_w = (sockbuf_t*)console_buffer(ind, CONSOLE_WRITE);
     char terminator = '\n';
+    char buf[MSG_LEN];
 
     /* Find this player */
     for (i = 1; i <= NumPlayers; i++)
@@ -417,6 +420,10 @@ static void console_whois(int ind, char *name)
     Packet_printf(console_buf_w, "%S", format("(%s@%s [%s] v%d.%d.%d.%d)\n", p->full_name,
         p->hostname, p->addr, major, minor, patch, extra));
 
+    /* Bandwidth */
+    Conn_describe_traffic(p->conn, buf, sizeof(buf));
+    Packet_printf(console_buf_w, "%S", format("%s\n", buf));
+
     /* Other interesting factoids */
     if (p->lives > 0)
         Packet_printf(console_buf_w, "%s", format("Has resurrected %d times.\n", p->lives));
@@ -667,6 +674,69 @@ static void console_help(int ind, char *name)
 }
 
 
+/*
+ * Write a line of the frame profile to a console
+ */
+static void console_profile_line(void *data, const char *line)
+{
+    sockbuf_t *console_buf_w = (sockbuf_t*)data;
+    char terminator = '\n';
+
+    Packet_printf(console_buf_w, "%s%c", line, (int)terminator);
+}
+
+
+/*
+ * Show the frame profile
+ */
+static void console_profile(int ind, char *mode)
+{
+    sockbuf_t *console_buf_w = (sockbuf_t*)console_buffer(ind, CONSOLE_WRITE);
+    char terminator = '\n';
+
+    if (mode && streq(mode, "reset"))
+    {
+        profile_reset();
+        Packet_printf(console_buf_w, "%s%c", "Profile cleared", (int)terminator);
+    }
+    else if (mode && streq(mode, "listen"))
+    {
+        Conn_set_console_setting(ind, CONSOLE_PROFILE, true);
+        Packet_printf(console_buf_w, "%s%c", "Periodic summaries enabled", (int)terminator);
+    }
+    else if (mode && streq(mode, "quiet"))
+    {
+        Conn_set_console_setting(ind, CONSOLE_PROFILE, false);
+        Packet_printf(console_buf_w, "%s%c", "Periodic summaries disabled", (int)terminator);
+    }
+    else
+        profile_dump(console_profile_line, console_buf_w);
+
+    Sockbuf_flush(console_buf_w);
+}
+
+
+/*
+ * Send the frame profile to all consoles that asked for periodic summaries
+ */
+void console_profile_summary(void)
+{
+    int k;
+
+    for (k = 0; k < Conn_active_num(); k++)
+    {
+        int i = Conn_active(k);
+        sockbuf_t *console_buf_w;
+
+        if (!Conn_is_alive(i) || !Conn_get_console_setting(i, CONSOLE_PROFILE)) continue;
+
+        console_buf_w = (sockbuf_t*)console_buffer(i, CONSOLE_WRITE);
+        profile_dump(console_profile_line, console_buf_w);
+        Sockbuf_flush(console_buf_w);
+    }
+}
+
+
 /*
  * This is the response function when incoming data is received on the
  * control pipe.
@@ -704,7 +704,7 @@ static void player_mods(struct player *p, int mod, bool *res, bool *vul)
     int adj;
 
     /* Unencumbered monks get speed bonus */
-    bool restrict = (player_has(p, PF_MARTIAL_ARTS) && !monk_armor_ok(p));
+    bool restricted = (player_has(p, PF_MARTIAL_ARTS) && !monk_armor_ok(p));
 
     /* Add racial modifiers */
     adj = race_modifier(p->race, mod, p->lev, false);
@@ -713,7 +713,7 @@ static void player_mods(struct player *p, int mod, bool *res, bool *vul)
 
     /* Add class modifiers */
     adj = class_modifier(p->clazz, mod, p->lev);
-    if ((mod == OBJ_MOD_SPEED) && restrict) adj = 0;
+    if ((mod == OBJ_MOD_SPEED) && restricted) adj = 0;
     if (adj > 0) *res = true;
     else if (adj < 0) *vul = true;
 
@@ -1449,6 +1449,9 @@ void redraw_stuff(struct player *p)
         p->full_refresh = p->upkeep->running_update;
     p->upkeep->running_update = false;
 
+    /* Hack -- if the client is lagging behind, don't update monster/object lists */
+    if (Conn_is_congested(p->conn)) p->full_refresh = false;
+
     /* For each listed flag, give an appropriate response */
     for (i = 0; i < N_ELEMENTS(redraw_events); i++)
     {
@@ -4924,19 +4927,23 @@ void bolt_pict(struct player *p, struct loc *start, struct loc *end, int typ, by
 
 /*
  * Draw an explosion
+ *
+ * The "drawing" and "drawn" arrays are indexed by the players on the level, and hold
+ * "num_players" entries. The latter is scratch space, filled here.
  */
-void display_explosion(struct chunk *cv, struct explosion *data, const bool *drawing, bool arc)
+void display_explosion(struct chunk *cv, struct explosion *data, const bool *drawing,
+    bool *drawn, int num_players, bool arc)
 {
     bool new_radius = false;
-    bool drawn[MAX_PLAYERS];
     int i, j;
     int proj_type = data->proj_type;
     int num_grids = data->num_grids;
     const int *distance_to_grid = data->distance_to_grid;
     struct loc *blast_grid = (struct loc *)data->blast_grid;
+    int n = MIN(num_players, cave_player_count(cv));
 
     /* Assume the player has seen no blast grids */
-    for (i = 0; i < MAX_PLAYERS; ++i) drawn[i] = false;
+    for (j = 0; j < n; j++) drawn[j] = false;
 
     /* Draw the blast from inside out */
     for (i = 0; i < num_grids; i++)
@@ -4945,12 +4952,11 @@ void display_explosion(struct chunk *cv, struct explosion *data, const bool *dra
         if (arc && !distance_to_grid[i]) continue;
 
         /* Do visuals for all players that can see the blast */
-        for (j = 1; j <= NumPlayers; j++)
+        for (j = 0; j < n; j++)
         {
-            struct player *p = player_get(j);
+            struct player *p = cave_player(cv, j);
 
             /* Skip irrelevant players */
-            if (!wpos_eq(&p->wpos, &cv->wpos)) continue;
             if (p->timed[TMD_BLIND]) continue;
             if (!panel_contains(p, &blast_grid[i])) continue;
             if (p->did_visuals) continue;
@@ -4981,12 +4987,11 @@ void display_explosion(struct chunk *cv, struct explosion *data, const bool *dra
         if (new_radius)
         {
             /* Flush all the grids at this radius for all players that can see the blast */
-            for (j = 1; j <= NumPlayers; j++)
+            for (j = 0; j < n; j++)
             {
-                struct player *p = player_get(j);
+                struct player *p = cave_player(cv, j);
 
                 /* Skip irrelevant players */
-                if (!wpos_eq(&p->wpos, &cv->wpos)) continue;
                 if (p->timed[TMD_BLIND]) continue;
 
                 /* Delay to show this radius appearing */
@@ -5001,12 +5006,11 @@ void display_explosion(struct chunk *cv, struct explosion *data, const bool *dra
     }
 
     /* Erase and flush for all players that can "see" the blast */
-    for (j = 1; j <= NumPlayers; j++)
+    for (j = 0; j < n; j++)
     {
-        struct player *p = player_get(j);
+        struct player *p = cave_player(cv, j);
 
         /* Skip irrelevant players */
-        if (!wpos_eq(&p->wpos, &cv->wpos)) continue;
         if (p->timed[TMD_BLIND]) continue;
 
         /* Erase and flush */
@@ -5032,12 +5036,11 @@ void display_explosion(struct chunk *cv, struct explosion *data, const bool *dra
     }
 
     /* Hack -- count how many blasts we have seen */
-    for (j = 1; j <= NumPlayers; j++)
+    for (j = 0; j < n; j++)
     {
-        struct player *p = player_get(j);
+        struct player *p = cave_player(cv, j);
 
         /* Skip irrelevant players */
-        if (!wpos_eq(&p->wpos, &cv->wpos)) continue;
         if (p->timed[TMD_BLIND]) continue;
 
         /* Add one to the count */
@@ -5048,18 +5051,20 @@ void display_explosion(struct chunk *cv, struct explosion *data, const bool *dra
 
 /*
  * Draw a moving spell effect (bolt or beam)
+ *
+ * The "drawing" array is indexed by the players on the level, and holds "num_players"
+ * entries.
  */
-void display_bolt(struct chunk *cv, struct bolt *data, bool *drawing)
+void display_bolt(struct chunk *cv, struct bolt *data, bool *drawing, int num_players)
 {
-    int j;
+    int j, n = MIN(num_players, cave_player_count(cv));
 
     /* Do visuals for all players that can "see" the bolt */
-    for (j = 1; j <= NumPlayers; j++)
+    for (j = 0; j < n; j++)
     {
-        struct player *p = player_get(j);
+        struct player *p = cave_player(cv, j);
 
         /* Skip irrelevant players */
-        if (!wpos_eq(&p->wpos, &cv->wpos)) continue;
         if (p->timed[TMD_BLIND]) continue;
         if (!panel_contains(p, &data->grid)) continue;
         if (p->did_visuals) continue;
@@ -58,8 +58,8 @@ extern void player_dump(struct player *p, bool server);
 extern void bolt_pict(struct player *p, struct loc *start, struct loc *end, int typ, byte *a,
     char *c);
 extern void display_explosion(struct chunk *cv, struct explosion *data, const bool *drawing,
-    bool arc);
-extern void display_bolt(struct chunk *cv, struct bolt *data, bool *drawing);
+    bool *drawn, int num_players, bool arc);
+extern void display_bolt(struct chunk *cv, struct bolt *data, bool *drawing, int num_players);
 extern void display_missile(struct chunk *cv, struct missile *data);
 extern void display_message(struct player *p, struct message *data);
 
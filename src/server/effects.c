@@ -575,8 +575,10 @@ static void give_detect(struct player *p, struct source *who)
     /* Players */
     if (who->player)
     {
-        if (p->play_det[who->idx]) power = 1;
-        p->play_det[who->idx] = MIN((int)p->play_det[who->idx] + power, 255);
+        struct player_vis *v = player_vis_get(p, who->player, true);
+
+        if (v->det) power = 1;
+        v->det = MIN((int)v->det + power, 255);
     }
 
     /* Monsters */
@@ -1175,6 +1177,7 @@ static bool effect_handler_ALTER_REALITY(effect_handler_context_t *context)
 
         /* Generate a new level (later) */
         q->upkeep->new_level_method = LEVEL_RAND;
+        q->upkeep->limbo = true;
     }
 
     /* Deallocate the level */
@@ -6,6 +6,8 @@
 #ifndef INCLUDED_EFFECTS_H
 #define INCLUDED_EFFECTS_H
 
+struct beam_info;
+
 /* Types of effect */
 typedef enum
 {
@@ -19,6 +19,9 @@
 
 
 #include "s-angband.h"
+#ifndef WINDOWS
+#include <signal.h>
+#endif
 
 
 bool server_generated;      /* The server exists */
@@ -496,6 +499,13 @@ static void digest_food(struct player *p)
 }
 
 
+/*
+ * Ring buffer used to propagate noise (grown to the size of the largest level seen)
+ */
+static int *noise_ring;
+static int noise_ring_size;
+
+
 /*
  * Every turn, the character makes enough noise that nearby monsters can use
  * it to home in.
@@ -511,44 +521,63 @@ static void digest_food(struct player *p)
  * values, thereby homing in on the player even though twisty tunnels and
  * mazes. Monsters have a hearing value, which is the largest sound value
  * they can detect.
+ *
+ * PWMAngband: the noise field only depends on the noise source, the player grid and the
+ * terrain of the level, so it is kept from one turn to the next and only recomputed when
+ * one of these has changed (the level gets a new flow stamp every time a grid changes
+ * from/to a feature that doesn't transmit sound).
  */
 static void make_noise(struct player *p)
 {
-    struct loc next;
+    struct loc source;
     int y, x, d;
-    int noise = 0;
-    struct queue *queue = q_new(p->cave->height * p->cave->width);
+    int head = 0, tail = 0;
+    int size = p->cave->height * p->cave->width;
     struct chunk *c = chunk_get(&p->wpos);
     struct loc *decoy = cave_find_decoy(c);
 
-    loc_copy(&next, &p->grid);
+    /* If there's a decoy, use that instead of the player */
+    if (!loc_is_zero(decoy)) loc_copy(&source, decoy);
+    else loc_copy(&source, &p->grid);
+
+    /* Nothing has changed since last time */
+    if ((p->cave->noise_stamp == c->flow_stamp) && loc_eq(&p->cave->noise_source, &source) &&
+        loc_eq(&p->cave->noise_player, &p->grid))
+    {
+        return;
+    }
+
+    p->cave->noise_stamp = c->flow_stamp;
+    loc_copy(&p->cave->noise_source, &source);
+    loc_copy(&p->cave->noise_player, &p->grid);
+
+    /* Every grid is enqueued at most once (the decoy grid may be enqueued twice) */
+    if (noise_ring_size < size + 1)
+    {
+        noise_ring = mem_realloc(noise_ring, (size + 1) * sizeof(int));
+        noise_ring_size = size + 1;
+    }
 
     /* Set all the grids to silence */
     for (y = 1; y < p->cave->height - 1; y++)
         for (x = 1; x < p->cave->width - 1; x++)
             p->cave->noise.grids[y][x] = 0;
 
-    /* If there's a decoy, use that instead of the player */
-    if (!loc_is_zero(decoy)) loc_copy(&next, decoy);
-
     /* Player makes noise */
-    p->cave->noise.grids[next.y][next.x] = noise;
-    q_push_int(queue, grid_to_i(&next, p->cave->width));
-    noise++;
+    p->cave->noise.grids[source.y][source.x] = 0;
+    noise_ring[tail] = grid_to_i(&source, p->cave->width);
+    tail = (tail + 1) % noise_ring_size;
 
     /* Propagate noise */
-    while (q_len(queue) > 0)
+    while (head != tail)
     {
-        /* Get the next grid */
-        i_to_grid(q_pop_int(queue), p->cave->width, &next);
+        struct loc next;
+        int noise;
 
-        /* If we've reached the current noise level, put it back and step */
-        if (p->cave->noise.grids[next.y][next.x] == noise)
-        {
-            q_push_int(queue, grid_to_i(&next, p->cave->width));
-            noise++;
-            continue;
-        }
+        /* Get the next grid */
+        i_to_grid(noise_ring[head], p->cave->width, &next);
+        head = (head + 1) % noise_ring_size;
+        noise = p->cave->noise.grids[next.y][next.x] + 1;
 
         /* Assign noise to the children and enqueue them */
         for (d = 0; d < 8; d++)
@@ -572,11 +601,10 @@ static void make_noise(struct player *p)
             p->cave->noise.grids[child.y][child.x] = noise;
 
             /* Enqueue that entry */
-            q_push_int(queue, grid_to_i(&child, p->cave->width));
+            noise_ring[tail] = grid_to_i(&child, p->cave->width);
+            tail = (tail + 1) % noise_ring_size;
         }
     }
-
-    q_free(queue);
 }
 
 
@@ -608,14 +636,7 @@ static void update_scent(struct player *p)
     struct chunk *c = chunk_get(&p->wpos);
 
     /* Update scent for all grids */
-    for (y = 1; y < p->cave->height - 1; y++)
-    {
-        for (x = 1; x < p->cave->width - 1; x++)
-        {
-            if (p->cave->scent.grids[y][x] > 0)
-                p->cave->scent.grids[y][x]++;
-        }
-    }
+    player_age_scent(p);
 
     /* Scentless player */
     if (p->timed[TMD_SCENTLESS]) return;
@@ -649,14 +670,14 @@ static void update_scent(struct player *p)
                 if ((x == 2) && (y == 2)) add_scent = true;
 
                 /* Adjacent to a closer grid, so valid */
-                if (p->cave->scent.grids[adj.y][adj.x] == new_scent - 1) add_scent = true;
+                if (player_scent(p, &adj) == new_scent - 1) add_scent = true;
             }
 
             /* Not valid */
             if (!add_scent) continue;
 
             /* Mark the scent */
-            p->cave->scent.grids[scent.y][scent.x] = new_scent;
+            player_set_scent(p, &scent, new_scent);
         }
     }
 }
@@ -680,12 +701,28 @@ static void process_player_world(struct player *p, struct chunk *c)
     }
 
     /* Hack -- fade player detect over time */
-    for (i = 1; i <= NumPlayers; i++)
+    for (i = 0; i < p->play_vis_num; i++)
     {
-        if (p->play_det[i])
+        struct player_vis *v = &p->play_vis[i];
+
+        if (v->det)
         {
-            p->play_det[i]--;
-            if (!p->play_det[i]) update_player(player_get(i));
+            v->det--;
+            if (!v->det)
+            {
+                int j;
+
+                for (j = 1; j <= NumPlayers; j++)
+                {
+                    struct player *q = player_get(j);
+
+                    if (q->id == v->id)
+                    {
+                        update_player(q);
+                        break;
+                    }
+                }
+            }
         }
     }
 
@@ -1095,31 +1132,25 @@ static void on_new_level(void)
 static void on_leave_level(void)
 {
     int i;
-    struct loc grid;
+    bool cached;
 
-    /* Deallocate any unused levels */
-    for (grid.y = radius_wild; grid.y >= 0 - radius_wild; grid.y--)
+    /* Deallocate any unused levels (backwards, since we remove them from the list) */
+    for (i = chunk_list_count() - 1; i >= 0; i--)
     {
-        for (grid.x = 0 - radius_wild; grid.x <= radius_wild; grid.x++)
-        {
-            struct wild_type *w_ptr = get_wt_info_at(&grid);
+        struct chunk *c = chunk_list_at(i);
 
-            /* Caves */
-            for (i = 0; i <= w_ptr->max_depth - w_ptr->min_depth; i++)
-            {
-                if (!w_ptr->chunk_list[i]) continue;
+        /* Don't deallocate special levels */
+        if (level_keep_allocated(c)) continue;
 
-                /* Don't deallocate special levels */
-                if (level_keep_allocated(w_ptr->chunk_list[i])) continue;
+        /* Remove the level from the game, keeping it in the level cache if possible */
+        chunk_list_remove(c);
+        cached = level_cache_add(c);
 
-                /* Hack -- deallocate custom houses */
-                wipe_custom_houses(&w_ptr->chunk_list[i]->wpos);
+        /* Hack -- deallocate custom houses */
+        wipe_custom_houses(&c->wpos);
 
-                /* Deallocate the level */
-                cave_wipe(w_ptr->chunk_list[i]);
-                w_ptr->chunk_list[i] = NULL;
-            }
-        }
+        /* Deallocate the level */
+        if (!cached) cave_wipe(c);
     }
 }
 
@@ -1138,6 +1169,9 @@ static void process_various(void)
     {
         int i;
 
+        /* Deallocate old levels (preserving artifacts on the ground) */
+        level_cache_flush();
+
         /* Save server state */
         save_server_info();
 
@@ -1426,7 +1460,15 @@ static void place_player(struct player *p, struct chunk *c, struct loc *grid)
 }
 
 
-static void generate_new_level(struct player *p)
+/*
+ * Place a player who is changing level on the new level.
+ *
+ * If the level doesn't exist yet and can_generate is false, nothing is done: the player
+ * stays in limbo (with upkeep->new_level_method set) until a later turn.
+ *
+ * Return true if a new level was generated.
+ */
+static bool generate_new_level(struct player *p, bool can_generate)
 {
     int id;
     bool new_level = false;
@@ -1437,7 +1479,13 @@ static void generate_new_level(struct player *p)
     c = chunk_get(&p->wpos);
 
     /* Paranoia */
-    if (!chunk_has_players(&p->wpos)) return;
+    if (!chunk_has_players(&p->wpos)) return false;
+
+    /* Somebody has entered a level that was vacated recently */
+    if (!c) c = level_cache_take(&p->wpos);
+
+    /* The level must be generated, but not this turn */
+    if (!c && !can_generate) return false;
 
     /* Play ambient sound on change of level. */
     play_ambient_sound(p);
@@ -1566,6 +1614,8 @@ static void generate_new_level(struct player *p)
 
     /* Add the player */
     square_set_mon(c, &p->grid, 0 - id);
+    p->upkeep->limbo = false;
+    cave_players_changed();
 
     /* Redraw */
     square_light_spot(c, &p->grid);
@@ -1602,6 +1652,8 @@ static void generate_new_level(struct player *p)
 
     /* Detect secret doors and traps */
     search(p, c);
+
+    return new_level;
 }
 
 
@@ -1708,27 +1760,23 @@ static void energize_monsters(struct chunk *c)
 static void pre_turn_game_loop(void)
 {
     int i;
-    struct loc grid;
+    u64b start;
 
     on_new_level();
 
     /* Handle any network stuff */
+    start = profile_ticks();
     Net_input();
+    profile_add(PROF_NET_INPUT, start);
 
     /* Process monsters with even more energy first */
-    for (grid.y = radius_wild; grid.y >= 0 - radius_wild; grid.y--)
+    for (i = chunk_list_count() - 1; i >= 0; i--)
     {
-        for (grid.x = 0 - radius_wild; grid.x <= radius_wild; grid.x++)
-        {
-            struct wild_type *w_ptr = get_wt_info_at(&grid);
-
-            for (i = 0; i <= w_ptr->max_depth - w_ptr->min_depth; i++)
-            {
-                struct chunk *c = w_ptr->chunk_list[i];
+        struct chunk *c = chunk_list_at(i);
 
-                if (c) process_monsters(c, true);
-            }
-        }
+        start = profile_ticks();
+        process_monsters(c, true);
+        profile_add_chunk(c, start);
     }
 
     /* Check for death */
@@ -1736,73 +1784,51 @@ static void pre_turn_game_loop(void)
 }
 
 
+/*
+ * First player to consider when generating new levels
+ */
+static int gen_start;
+
+
 /*
  * Post-turn game loop.
  */
 static void post_turn_game_loop(void)
 {
     int i;
-    struct loc grid;
+    u64b start;
 
     /* Check for death */
     process_death();
 
     /* Process the rest of the monsters */
-    for (grid.y = radius_wild; grid.y >= 0 - radius_wild; grid.y--)
+    for (i = chunk_list_count() - 1; i >= 0; i--)
     {
-        for (grid.x = 0 - radius_wild; grid.x <= radius_wild; grid.x++)
-        {
-            struct wild_type *w_ptr = get_wt_info_at(&grid);
-
-            for (i = 0; i <= w_ptr->max_depth - w_ptr->min_depth; i++)
-            {
-                struct chunk *c = w_ptr->chunk_list[i];
+        struct chunk *c = chunk_list_at(i);
 
-                if (c)
-                {
-                    process_monsters(c, false);
+        start = profile_ticks();
+        process_monsters(c, false);
 
-                    /* Mark all monsters as ready to act when they have the energy */
-                    reset_monsters(c);
-                }
-            }
-        }
+        /* Mark all monsters as ready to act when they have the energy */
+        reset_monsters(c);
+        profile_add_chunk(c, start);
     }
 
     /* Check for death */
     process_death();
 
     /* Process the objects */
-    for (grid.y = radius_wild; grid.y >= 0 - radius_wild; grid.y--)
-    {
-        for (grid.x = 0 - radius_wild; grid.x <= radius_wild; grid.x++)
-        {
-            struct wild_type *w_ptr = get_wt_info_at(&grid);
-
-            for (i = 0; i <= w_ptr->max_depth - w_ptr->min_depth; i++)
-            {
-                struct chunk *c = w_ptr->chunk_list[i];
-
-                if (c) process_objects(c);
-            }
-        }
-    }
+    start = profile_ticks();
+    for (i = chunk_list_count() - 1; i >= 0; i--)
+        process_objects(chunk_list_at(i));
+    profile_add(PROF_OBJECTS, start);
 
-    /* Process the world */
-    for (grid.y = radius_wild; grid.y >= 0 - radius_wild; grid.y--)
+    /* Process the world every ten turns */
+    start = profile_ticks();
+    if (!(turn.turn % 10))
     {
-        for (grid.x = 0 - radius_wild; grid.x <= radius_wild; grid.x++)
-        {
-            struct wild_type *w_ptr = get_wt_info_at(&grid);
-
-            for (i = 0; i <= w_ptr->max_depth - w_ptr->min_depth; i++)
-            {
-                struct chunk *c = w_ptr->chunk_list[i];
-
-                /* Process the world every ten turns */
-                if (c && !(turn.turn % 10)) process_world(NULL, c);
-            }
-        }
+        for (i = chunk_list_count() - 1; i >= 0; i--)
+            process_world(NULL, chunk_list_at(i));
     }
 
     /* Process the world */
@@ -1814,9 +1840,12 @@ static void post_turn_game_loop(void)
         if (!p->upkeep->new_level_method && !p->upkeep->funeral)
             process_world(p, chunk_get(&p->wpos));
     }
+    profile_add(PROF_WORLD, start);
 
     /* Process everything else */
+    start = profile_ticks();
     process_various();
+    profile_add(PROF_VARIOUS, start);
 
     /* Give energy to all players */
     for (i = 1; i <= NumPlayers; i++)
@@ -1828,20 +1857,8 @@ static void post_turn_game_loop(void)
     }
 
     /* Give energy to all monsters */
-    for (grid.y = radius_wild; grid.y >= 0 - radius_wild; grid.y--)
-    {
-        for (grid.x = 0 - radius_wild; grid.x <= radius_wild; grid.x++)
-        {
-            struct wild_type *w_ptr = get_wt_info_at(&grid);
-
-            for (i = 0; i <= w_ptr->max_depth - w_ptr->min_depth; i++)
-            {
-                struct chunk *c = w_ptr->chunk_list[i];
-
-                if (c) energize_monsters(c);
-            }
-        }
-    }
+    for (i = chunk_list_count() - 1; i >= 0; i--)
+        energize_monsters(chunk_list_at(i));
 
     /* Count game turns */
     ht_add(&turn, 1);
@@ -1880,6 +1897,8 @@ static void post_turn_game_loop(void)
     {
         struct player *p = player_get(i);
 
+        start = profile_ticks();
+
         /* Full refresh (includes monster/object lists) */
         p->full_refresh = true;
 
@@ -1888,10 +1907,15 @@ static void post_turn_game_loop(void)
 
         /* Normal refresh (without monster/object lists) */
         p->full_refresh = false;
+
+        profile_add_player(p, start);
     }
 
     /* Send any information over the network */
+    start = profile_ticks();
     Net_output();
+    profile_add(PROF_NET_OUTPUT, start);
+    if (bench_turns) bench_add(BENCH_NET_OUTPUT, start);
 
     /* Get rid of dead players */
     for (i = NumPlayers; i > 0; i--)
@@ -1935,15 +1959,32 @@ static void post_turn_game_loop(void)
         Destroy_connection(p->conn, "Starving to death!");
     }
 
+    start = profile_ticks();
     on_leave_level();
+    profile_add(PROF_LEAVE_LEVEL, start);
 
-    /* Make a new level if requested */
-    for (i = 1; i <= NumPlayers; i++)
+    /*
+     * Make a new level if requested. Generating a level is slow, so only one level is
+     * generated per turn: other players who need a new level are held in limbo until a
+     * later turn. Start with a different player every turn so that nobody waits forever.
+     */
+    start = profile_ticks();
+    if (NumPlayers)
     {
-        struct player *p = player_get(i);
+        bool generated = false;
+        int n;
 
-        if (p->upkeep->new_level_method) generate_new_level(p);
+        gen_start = gen_start % NumPlayers;
+        for (n = 0; n < NumPlayers; n++)
+        {
+            struct player *p = player_get((gen_start + n) % NumPlayers + 1);
+
+            if (!p->upkeep->new_level_method) continue;
+            if (generate_new_level(p, !generated)) generated = true;
+        }
+        gen_start++;
     }
+    profile_add(PROF_NEW_LEVEL, start);
 }
 
 
@@ -2029,6 +2070,9 @@ static void process_player_turn_based(struct player *p)
 void run_game_loop(void)
 {
     int i;
+    u64b start;
+
+    profile_frame_begin();
 
     /* HIGHLY EXPERIMENTAL: turn-based mode (for single player games) */
     if (TURN_BASED && process_turn_based())
@@ -2063,13 +2107,17 @@ void run_game_loop(void)
             Net_output_p(p);
         }
 
+        profile_frame_end();
         return;
     }
 
     /* Execute pre-turn processing */
+    start = profile_ticks();
     pre_turn_game_loop();
+    if (bench_turns) bench_add(BENCH_PRE_TURN, start);
 
     /* Process the players */
+    start = profile_ticks();
     for (i = 1; i <= NumPlayers; i++)
     {
         struct player *p = player_get(i);
@@ -2077,9 +2125,20 @@ void run_game_loop(void)
         /* Process that player */
         if (!p->upkeep->new_level_method && !p->upkeep->funeral) process_player(p);
     }
+    profile_add(PROF_PLAYERS, start);
+    if (bench_turns) bench_add(BENCH_PROCESS_PLAYER, start);
 
     /* Execute post-turn processing */
+    start = profile_ticks();
     post_turn_game_loop();
+    if (bench_turns) bench_add(BENCH_POST_TURN, start);
+
+    /* Deallocate old levels */
+    start = profile_ticks();
+    level_cache_process();
+    profile_add(PROF_LEAVE_LEVEL, start);
+
+    profile_frame_end();
 }
 
 
@@ -2248,6 +2307,9 @@ static void close_game(void)
         }
     }
 
+    /* Deallocate old levels */
+    level_cache_flush();
+
     /* Preserve artifacts on the ground */
     preserve_artifacts();
 
@@ -2267,6 +2329,9 @@ void play_game(void)
     /* Flash a message */
     plog("Please wait...");
 
+    /* Benchmark mode: use a fixed seed so that each run does the same work */
+    if (bench_turns) Rand_state_init(BENCH_SEED);
+
     /* Attempt to load the server state information */
     if (!load_server_info())
         quit("Broken server savefile");
@@ -2289,6 +2354,14 @@ void play_game(void)
     /* Server initialization is now "complete" */
     server_generated = true;
 
+    /* Benchmark mode: no network, no scheduler */
+    if (bench_turns)
+    {
+        if (Setup_net_server() == -1)
+            quit("Couldn't set up net server");
+        run_bench();
+    }
+
     /* Set up the contact socket, so we can allow players to connect */
     setup_contact_socket();
 
@@ -2343,6 +2416,9 @@ void shutdown_server(void)
         Destroy_connection(p->conn, "Server shutdown (save succeeded)");
     }
 
+    /* Deallocate old levels */
+    level_cache_flush();
+
     /* Preserve artifacts on the ground */
     preserve_artifacts();
 
@@ -2415,6 +2491,9 @@ void exit_game_panic(void)
         i++;
     }
 
+    /* Deallocate old levels */
+    level_cache_flush();
+
     /* Preserve artifacts on the ground */
     preserve_artifacts();
 
@@ -2432,6 +2511,8 @@ void exit_game_panic(void)
 }
 
 
+#ifdef WINDOWS
+
 /*
  * Windows specific replacement for signal handling
  */
@@ -2494,4 +2575,59 @@ void setup_exit_handler(void)
 
     /* Trap unhandled exceptions, i.e. server crashes */
     old_handler = SetUnhandledExceptionFilter(UnhandledExceptionFilter);
-}
\ No newline at end of file
+}
+
+#else
+
+/*
+ * Signal handler for "nice" termination requests (kill, CTRL+C, hangup)
+ */
+static void term_handler(int sig)
+{
+    /* Save everything and quit the game */
+    shutdown_server();
+}
+
+
+/*
+ * Signal handler for fatal errors
+ *
+ * If the server crashes under Unix, this is where we end up
+ */
+static void panic_handler(int sig)
+{
+    /* Only once */
+    signal(sig, SIG_DFL);
+
+    /* Record the crash */
+    if (server_generated) plog_fmt("Caught signal %d", sig);
+
+    /* Save everything and quit the game */
+    exit_game_panic();
+
+    /* Let the default handler dump core */
+    raise(sig);
+}
+
+
+void setup_exit_handler(void)
+{
+    /* A client that disconnects while we write to it must not kill the server */
+    signal(SIGPIPE, SIG_IGN);
+
+    /* Trap CTRL+C, kill, hangup */
+    signal(SIGINT, term_handler);
+    signal(SIGTERM, term_handler);
+    signal(SIGHUP, term_handler);
+
+    /* Trap server crashes */
+    signal(SIGSEGV, panic_handler);
+    signal(SIGBUS, panic_handler);
+    signal(SIGFPE, panic_handler);
+    signal(SIGILL, panic_handler);
+    signal(SIGABRT, panic_handler);
+
+    plog("Initialised exit save handler.");
+}
+
+#endif
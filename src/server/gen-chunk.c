@@ -38,6 +38,19 @@ static int chunk_index(struct wild_type *w_ptr, int depth)
 }
 
 
+/*
+ * Dense list of all allocated levels.
+ *
+ * Only a handful of levels are allocated at any time, so the per-turn processing iterates
+ * over this list instead of scanning the chunk lists of the whole wilderness. Removal swaps
+ * the last entry into the freed slot, so the list should be walked backwards if levels may
+ * be deallocated in the process (levels added in the process are then skipped).
+ */
+static struct chunk **chunk_active;
+static int chunk_active_num;
+static int chunk_active_max;
+
+
 /*
  * Add an entry to the chunk list.
  *
@@ -48,6 +61,20 @@ void chunk_list_add(struct chunk *c)
     struct wild_type *w_ptr = get_wt_info_at(&c->wpos.grid);
 
     w_ptr->chunk_list[chunk_index(w_ptr, c->wpos.depth)] = c;
+    cave_players_changed();
+
+    /* Paranoia */
+    if (c->active_idx != -1) return;
+
+    /* Grow the list if needed */
+    if (chunk_active_num == chunk_active_max)
+    {
+        chunk_active_max = (chunk_active_max? chunk_active_max * 2: 32);
+        chunk_active = mem_realloc(chunk_active, chunk_active_max * sizeof(struct chunk *));
+    }
+
+    c->active_idx = chunk_active_num;
+    chunk_active[chunk_active_num++] = c;
 }
 
 
@@ -61,6 +88,255 @@ void chunk_list_remove(struct chunk *c)
     struct wild_type *w_ptr = get_wt_info_at(&c->wpos.grid);
 
     w_ptr->chunk_list[chunk_index(w_ptr, c->wpos.depth)] = NULL;
+    cave_players_changed();
+
+    /* Paranoia */
+    if (c->active_idx == -1) return;
+
+    /* Move the last entry into the free slot */
+    chunk_active_num--;
+    chunk_active[c->active_idx] = chunk_active[chunk_active_num];
+    chunk_active[c->active_idx]->active_idx = c->active_idx;
+    chunk_active[chunk_active_num] = NULL;
+    c->active_idx = -1;
+}
+
+
+/*
+ * Get the number of allocated levels.
+ */
+int chunk_list_count(void)
+{
+    return chunk_active_num;
+}
+
+
+/*
+ * Get an allocated level from its index in the list of allocated levels.
+ */
+struct chunk *chunk_list_at(int idx)
+{
+    return chunk_active[idx];
+}
+
+
+/*
+ * Free the list of allocated levels.
+ */
+void chunk_list_free(void)
+{
+    mem_free(chunk_active);
+    chunk_active = NULL;
+    chunk_active_num = 0;
+    chunk_active_max = 0;
+}
+
+
+/*
+ * Cache of recently vacated levels.
+ *
+ * When the last player leaves a level, the level is removed from the chunk list (so for the
+ * rest of the game, it doesn't exist anymore) but it is not deallocated right away: it is
+ * put at the end of this list instead. Once per game turn, after everything else has been
+ * processed, the first level that cannot be reused (or the oldest level if the cache takes
+ * more than LEVEL_CACHE_SIZE kilobytes) is deallocated.
+ *
+ * If a player enters a level that is still in the cache, the level is either put back in
+ * the chunk list, if it is not deeper than LEVEL_CACHE_DEPTH, or deallocated right away so
+ * that a new level can be generated as usual.
+ */
+struct level_cache_entry
+{
+    struct chunk *c;    /* The level */
+    bool reuse;         /* Can the level be reused? */
+};
+
+
+static struct level_cache_entry *level_cache;
+static int level_cache_num;
+static int level_cache_max;
+static size_t level_cache_used;
+static u32b level_cache_hits;
+static u32b level_cache_misses;
+static u32b level_cache_evictions;
+
+
+/*
+ * Rough amount of memory used by a level
+ */
+static size_t level_cache_size(struct chunk *c)
+{
+    return c->height * c->width * sizeof(struct square) +
+        z_info->level_monster_max * (sizeof(struct monster) + sizeof(struct monster_group *));
+}
+
+
+/*
+ * Find a level in the cache
+ */
+static int level_cache_find(struct worldpos *wpos)
+{
+    int i;
+
+    for (i = 0; i < level_cache_num; i++)
+    {
+        if (wpos_eq(&level_cache[i].c->wpos, wpos)) return i;
+    }
+
+    return -1;
+}
+
+
+/*
+ * Remove a level from the cache, keeping the others in LRU order
+ */
+static struct chunk *level_cache_remove(int idx)
+{
+    struct chunk *c = level_cache[idx].c;
+
+    level_cache_used -= level_cache_size(c);
+    level_cache_num--;
+    memmove(&level_cache[idx], &level_cache[idx + 1],
+        (level_cache_num - idx) * sizeof(struct level_cache_entry));
+
+    return c;
+}
+
+
+/*
+ * Deallocate a level from the cache
+ */
+static void level_cache_evict(int idx)
+{
+    cave_wipe(level_cache_remove(idx));
+    level_cache_evictions++;
+}
+
+
+/*
+ * Put a level that has just been vacated (and removed from the chunk list) in the cache.
+ *
+ * Return false if the cache is disabled (the level should be deallocated immediately).
+ */
+bool level_cache_add(struct chunk *c)
+{
+    if (!cfg_level_cache_size) return false;
+
+    /* Grow the list if needed */
+    if (level_cache_num == level_cache_max)
+    {
+        level_cache_max = (level_cache_max? level_cache_max * 2: 8);
+        level_cache = mem_realloc(level_cache, level_cache_max * sizeof(struct level_cache_entry));
+    }
+
+    /* Custom houses are wiped when the level is vacated, so such levels can't be reused */
+    level_cache[level_cache_num].c = c;
+    level_cache[level_cache_num].reuse = ((c->wpos.depth <= cfg_level_cache_depth) &&
+        !level_has_custom_houses(&c->wpos));
+    level_cache_num++;
+    level_cache_used += level_cache_size(c);
+
+    return true;
+}
+
+
+/*
+ * Get a level back from the cache when a player enters it.
+ *
+ * Return NULL if the level must be generated.
+ */
+struct chunk *level_cache_take(struct worldpos *wpos)
+{
+    int idx = level_cache_find(wpos);
+    struct chunk *c;
+
+    /* Not there */
+    if (idx == -1)
+    {
+        if (cfg_level_cache_size) level_cache_misses++;
+        return NULL;
+    }
+
+    /* Level must be regenerated */
+    if (!level_cache[idx].reuse)
+    {
+        level_cache_evict(idx);
+        level_cache_misses++;
+        return NULL;
+    }
+
+    /* Reuse the level */
+    c = level_cache_remove(idx);
+    chunk_list_add(c);
+    level_cache_hits++;
+
+    return c;
+}
+
+
+/*
+ * Deallocate a level from the cache before a new level is generated at the same location
+ */
+void level_cache_forget(struct worldpos *wpos)
+{
+    int idx = level_cache_find(wpos);
+
+    if (idx != -1) level_cache_evict(idx);
+}
+
+
+/*
+ * Deallocate at most one level from the cache (called once per game turn)
+ */
+void level_cache_process(void)
+{
+    int i;
+
+    /* Levels that can't be reused go first */
+    for (i = 0; i < level_cache_num; i++)
+    {
+        if (!level_cache[i].reuse)
+        {
+            level_cache_evict(i);
+            return;
+        }
+    }
+
+    /* Then the oldest levels if the cache is too big */
+    if (level_cache_num && (level_cache_used > (size_t)cfg_level_cache_size * 1024))
+        level_cache_evict(0);
+}
+
+
+/*
+ * Deallocate all levels from the cache
+ */
+void level_cache_flush(void)
+{
+    while (level_cache_num) level_cache_evict(level_cache_num - 1);
+}
+
+
+/*
+ * Deallocate the cache
+ */
+void level_cache_free(void)
+{
+    level_cache_flush();
+    mem_free(level_cache);
+    level_cache = NULL;
+    level_cache_max = 0;
+}
+
+
+/*
+ * Describe the state of the cache
+ */
+void level_cache_describe(char *buf, size_t len)
+{
+    strnfmt(buf, len, "Level cache: %d levels (%lu KB), %lu hits, %lu misses, %lu evictions",
+        level_cache_num, (unsigned long)(level_cache_used / 1024), (unsigned long)level_cache_hits,
+        (unsigned long)level_cache_misses, (unsigned long)level_cache_evictions);
 }
 
 
@@ -1296,6 +1296,9 @@ struct chunk *prepare_next_level(struct player *p, struct worldpos *wpos)
         }
     }
 
+    /* Deallocate any old version of the level */
+    level_cache_forget(wpos);
+
     /* Generate a new level */
     c = cave_generate(p, wpos, min_height, min_width);
 
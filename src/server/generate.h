@@ -248,6 +248,16 @@ extern struct chunk *arena_gen(struct player *p, struct worldpos *wpos, int min_
 /* gen-chunk.c */
 extern void chunk_list_add(struct chunk *c);
 extern void chunk_list_remove(struct chunk *c);
+extern int chunk_list_count(void);
+extern struct chunk *chunk_list_at(int idx);
+extern void chunk_list_free(void);
+extern bool level_cache_add(struct chunk *c);
+extern struct chunk *level_cache_take(struct worldpos *wpos);
+extern void level_cache_forget(struct worldpos *wpos);
+extern void level_cache_process(void);
+extern void level_cache_flush(void);
+extern void level_cache_free(void);
+extern void level_cache_describe(char *buf, size_t len);
 extern void chunk_validate_objects(struct chunk *c);
 extern struct chunk *chunk_get(struct worldpos *wpos);
 extern bool chunk_inhibit_players(struct worldpos *wpos);
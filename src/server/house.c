@@ -315,6 +315,22 @@ bool level_has_owned_houses(struct worldpos *wpos)
 }
 
 
+/*
+ * Determine if the level contains extended or custom houses
+ */
+bool level_has_custom_houses(struct worldpos *wpos)
+{
+    int i;
+
+    for (i = 0; i < houses_count(); i++)
+    {
+        if (wpos_eq(&houses[i].wpos, wpos) && (houses[i].state >= HOUSE_EXTENDED)) return true;
+    }
+
+    return false;
+}
+
+
 /*
  * Wipe custom houses on a level
  */
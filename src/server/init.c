@@ -46,12 +46,18 @@ u32b cfg_max_account_chars = 12;
 bool cfg_no_steal = true;
 bool cfg_newbies_cannot_drop = true;
 s32b cfg_level_unstatic_chance = 60;
+s32b cfg_level_cache_size = 16384;
+s16b cfg_level_cache_depth = -1;
 bool cfg_random_artifacts = false;
 s32b cfg_retire_timer = -1;
 bool cfg_more_towns = false;
 bool cfg_artifact_drop_shallow = true;
 bool cfg_limit_player_connections = true;
 s32b cfg_tcp_port = 18346;
+s16b cfg_compress_level = 1;
+s32b cfg_compress_min_size = 64;
+s32b cfg_output_queue_high = 256;
+s32b cfg_output_queue_max = 4096;
 bool cfg_chardump_color = false;
 s16b cfg_pvp_hostility = PVP_SAFE;
 bool cfg_base_monsters = true;
@@ -3776,6 +3782,9 @@ void cleanup_angband(void)
 
     /* Misc */
     wipe_player_names();
+    player_cave_pool_free();
+    project_free();
+    randart_cache_flush();
 
     /* Free the player presets */
     for (i = 0; i < presets_count; i++)
@@ -3813,6 +3822,9 @@ void cleanup_angband(void)
 
     /* Stop the network server */
     Stop_net_server();
+
+    /* Free the object pool */
+    object_pool_free();
 }
 
 
@@ -3891,6 +3903,20 @@ static void set_server_option(const char *option, char *value)
         cfg_newbies_cannot_drop = str_to_boolean(value);
     else if (!strcmp(option, "LEVEL_UNSTATIC_CHANCE"))
         cfg_level_unstatic_chance = atoi(value);
+    else if (!strcmp(option, "LEVEL_CACHE_SIZE"))
+    {
+        cfg_level_cache_size = atoi(value);
+
+        /* Sanity checks */
+        if (cfg_level_cache_size < 0) cfg_level_cache_size = 0;
+    }
+    else if (!strcmp(option, "LEVEL_CACHE_DEPTH"))
+    {
+        cfg_level_cache_depth = atoi(value);
+
+        /* Sanity checks */
+        if (cfg_level_cache_depth < -1) cfg_level_cache_depth = -1;
+    }
     else if (!strcmp(option, "RETIRE_TIMER"))
         cfg_retire_timer = atoi(value);
     else if (!strcmp(option, "ALLOW_RANDOM_ARTIFACTS"))
@@ -3911,6 +3937,35 @@ static void set_server_option(const char *option, char *value)
         if ((cfg_tcp_port > 65535) || (cfg_tcp_port < 1))
             cfg_tcp_port = 18346;
     }
+    else if (!strcmp(option, "COMPRESSION_LEVEL"))
+    {
+        cfg_compress_level = atoi(value);
+
+        /* Sanity checks */
+        if (cfg_compress_level < 0) cfg_compress_level = 0;
+        if (cfg_compress_level > 9) cfg_compress_level = 9;
+    }
+    else if (!strcmp(option, "COMPRESSION_MIN_SIZE"))
+    {
+        cfg_compress_min_size = atoi(value);
+
+        /* Sanity checks */
+        if (cfg_compress_min_size < 0) cfg_compress_min_size = 0;
+    }
+    else if (!strcmp(option, "OUTPUT_QUEUE_HIGH"))
+    {
+        cfg_output_queue_high = atoi(value);
+
+        /* Sanity checks */
+        if (cfg_output_queue_high < 0) cfg_output_queue_high = 0;
+    }
+    else if (!strcmp(option, "OUTPUT_QUEUE_MAX"))
+    {
+        cfg_output_queue_max = atoi(value);
+
+        /* Sanity checks */
+        if (cfg_output_queue_max < 0) cfg_output_queue_max = 0;
+    }
     else if (!strcmp(option, "CHARACTER_DUMP_COLOR"))
         cfg_chardump_color = str_to_boolean(value);
     else if (!strcmp(option, "PVP_HOSTILITY"))
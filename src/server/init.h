@@ -26,12 +26,18 @@ extern u32b cfg_max_account_chars;
 extern bool cfg_no_steal;
 extern bool cfg_newbies_cannot_drop;
 extern s32b cfg_level_unstatic_chance;
+extern s32b cfg_level_cache_size;
+extern s16b cfg_level_cache_depth;
 extern s32b cfg_retire_timer;
 extern bool cfg_random_artifacts;
 extern bool cfg_more_towns;
 extern bool cfg_artifact_drop_shallow;
 extern bool cfg_limit_player_connections;
 extern s32b cfg_tcp_port;
+extern s16b cfg_compress_level;
+extern s32b cfg_compress_min_size;
+extern s32b cfg_output_queue_high;
+extern s32b cfg_output_queue_max;
 extern bool cfg_chardump_color;
 extern s16b cfg_pvp_hostility;
 extern bool cfg_base_monsters;
@@ -1373,7 +1373,10 @@ static int rd_player_objects_aux(struct player *p, rd_item_t rd_item_version)
 
         /* Place object in player object list */
         if (player_square_in_bounds_fully(p, &obj->grid))
+        {
             pile_insert_end(&square_p(p, &obj->grid)->obj, obj);
+            square_track_pile(p, &obj->grid);
+        }
     }
 
     return 0;
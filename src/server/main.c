@@ -169,7 +169,9 @@ static void show_version(void)
  */
 int main(int argc, char *argv[])
 {
+#ifdef WINDOWS
     WSADATA wsadata;
+#endif
     char buf[MSG_LEN];
 
     /* Setup assert hook */
@@ -184,12 +186,14 @@ int main(int argc, char *argv[])
     /* Save the "program name" */
     argv0 = argv[0];
 
+#ifdef WINDOWS
     /* Load our debugging library on Windows, to give us nice stack dumps */
     /* We use exchndl.dll from the mingw-utils package */
     LoadLibrary("exchndl.dll");
 
     /* Initialize WinSock */
     WSAStartup(MAKEWORD(1, 1), &wsadata);
+#endif
 
     /* Process the command line arguments */
     for (--argc, ++argv; argc > 0; --argc, ++argv)
@@ -203,12 +207,26 @@ int main(int argc, char *argv[])
             case 'v':
                 show_version();
 
+            case '-':
+            {
+                /* Run the benchmark */
+                if (streq(argv[0], "--bench") && (argc > 1))
+                {
+                    --argc, ++argv;
+                    bench_turns = (u32b)atol(argv[0]);
+                    if (bench_turns) break;
+                }
+
+                goto usage;
+            }
+
             default:
                 usage:
 
                 /* Note -- the Term is NOT initialized */
                 puts("Usage: mangband [options]");
                 puts("  -v   Show version");
+                puts("  --bench <turns>   Run the game loop <turns> times with scripted players");
 
                 /* Actually abort the process */
                 quit(NULL);
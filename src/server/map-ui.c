@@ -1015,6 +1015,9 @@ void display_map(struct player *p, bool subwindow)
     u16b **ma;
     char **mc;
 
+    /* Send the pending changes of the map (scr_info is used as scratch space below) */
+    Send_dirty_chars(p);
+
     /* Desired map size */
     map_hgt = p->max_hgt - ROW_MAP - 1;
     map_wid = p->screen_cols;
@@ -1192,6 +1195,9 @@ static void wild_display_map(struct player *p)
     char **mc;
     char buf[NORMAL_WID];
 
+    /* Send the pending changes of the map (scr_info is used as scratch space below) */
+    Send_dirty_chars(p);
+
     /* Desired map size */
     map_hgt = p->max_hgt - ROW_MAP - 1;
     map_wid = p->screen_cols;
@@ -108,13 +108,18 @@ void msg(struct player *p, const char *fmt, ...)
  */
 void msg_print_complex_near(struct player *p, struct player *q, u16b type, const char *msg)
 {
-    int i;
+    int i, n;
+    struct chunk *c = chunk_get(&p->wpos);
 
-    /* Check each player */
-    for (i = 1; i <= NumPlayers; i++)
+    /* Paranoia */
+    if (!c) return;
+
+    /* Check each player on this level */
+    n = cave_player_count(c);
+    for (i = 0; i < n; i++)
     {
         /* Check this player */
-        struct player *player = player_get(i);
+        struct player *player = cave_player(c, i);
 
         /* Don't send the message to the player who caused it */
         if (p == player) continue;
@@ -122,9 +127,6 @@ void msg_print_complex_near(struct player *p, struct player *q, u16b type, const
         /* Don't send the message to the second ignoree */
         if (q == player) continue;
 
-        /* Make sure this player is on this level */
-        if (!wpos_eq(&player->wpos, &p->wpos)) continue;
-
         /* Can he see this player? */
         if (square_isview(player, &p->grid))
         {
@@ -224,20 +226,22 @@ void msg_format_complex_far(struct player *p, u16b type, const char *fmt, const
 void msg_print_near(struct player *p, u16b type, const char *msg)
 {
     char p_name[NORMAL_WID], buf[NORMAL_WID];
-    int i;
+    int i, n;
+    struct chunk *c = chunk_get(&p->wpos);
 
-    /* Check each player */
-    for (i = 1; i <= NumPlayers; i++)
+    /* Paranoia */
+    if (!c) return;
+
+    /* Check each player at this depth */
+    n = cave_player_count(c);
+    for (i = 0; i < n; i++)
     {
         /* Check this player */
-        struct player *q = player_get(i);
+        struct player *q = cave_player(c, i);
 
         /* Don't send the message to the player who caused it */
         if (p == q) continue;
 
-        /* Make sure this player is at this depth */
-        if (!wpos_eq(&q->wpos, &p->wpos)) continue;
-
         /* Can he see this player? */
         if (square_isview(q, &p->grid))
         {
@@ -359,7 +359,7 @@ struct monster_group *summon_group(struct chunk *c, struct monster *mon)
 void monster_group_rouse(struct player *p, struct chunk *c, struct monster *mon)
 {
     int index = mon->group_info[PRIMARY_GROUP].index;
-    struct monster_group *group = c->monster_groups[mon->group_info[index].index];
+    struct monster_group *group = c->monster_groups[index];
     struct mon_group_list_entry *entry = group->member_list;
 
     /* Not aware means don't rouse */
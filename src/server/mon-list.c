@@ -22,6 +22,101 @@
 #include "s-angband.h"
 
 
+/*
+ * Each player keeps the list of the monsters that update_mon_aux() found visible, so that
+ * the monster list doesn't have to go through the whole monster array of the level. The
+ * monsters that are no longer visible are dropped from it when the list is collected.
+ */
+
+
+/*
+ * Remember that a monster is visible to the player.
+ */
+void monster_list_track(struct player *p, int m_idx)
+{
+    if (p->mon_seen_pos[m_idx]) return;
+
+    p->mon_seen[p->mon_seen_num++] = (s16b)m_idx;
+    p->mon_seen_pos[m_idx] = (u16b)p->mon_seen_num;
+}
+
+
+/*
+ * Forget a monster (deleted from the level).
+ */
+void monster_list_untrack(struct player *p, int m_idx)
+{
+    int last;
+    u16b pos = p->mon_seen_pos[m_idx];
+
+    if (!pos) return;
+
+    last = p->mon_seen[--p->mon_seen_num];
+    p->mon_seen[pos - 1] = (s16b)last;
+    p->mon_seen_pos[last] = pos;
+    p->mon_seen_pos[m_idx] = 0;
+}
+
+
+/*
+ * Follow a monster moved to another slot (monster array compaction).
+ */
+void monster_list_move(struct player *p, int from, int to)
+{
+    u16b pos = p->mon_seen_pos[from];
+
+    monster_list_untrack(p, to);
+    if (!pos) return;
+
+    p->mon_seen[pos - 1] = (s16b)to;
+    p->mon_seen_pos[to] = pos;
+    p->mon_seen_pos[from] = 0;
+}
+
+
+/*
+ * Forget all monsters (new level).
+ */
+void monster_list_forget(struct player *p)
+{
+    int i;
+
+    for (i = 0; i < p->mon_seen_num; i++) p->mon_seen_pos[p->mon_seen[i]] = 0;
+    p->mon_seen_num = 0;
+}
+
+
+/*
+ * Drop the monsters that are no longer visible from the list of seen monsters, and put
+ * the others back in index order (the list is only shuffled a little between two calls,
+ * so a simple insertion sort will do).
+ */
+static void monster_list_prune(struct player *p, struct chunk *c)
+{
+    int i, j, n = 0;
+
+    for (i = 0; i < p->mon_seen_num; i++)
+    {
+        int m_idx = p->mon_seen[i];
+
+        /* Keep visible monsters (camouflaged ones may be revealed later) */
+        if ((m_idx < cave_monster_max(c)) && cave_monster(c, m_idx)->race &&
+            monster_is_visible(p, m_idx))
+        {
+            for (j = n; (j > 0) && (p->mon_seen[j - 1] > m_idx); j--)
+                p->mon_seen[j] = p->mon_seen[j - 1];
+            p->mon_seen[j] = (s16b)m_idx;
+            n++;
+        }
+        else
+            p->mon_seen_pos[m_idx] = 0;
+    }
+
+    p->mon_seen_num = n;
+    for (i = 0; i < n; i++) p->mon_seen_pos[p->mon_seen[i]] = (u16b)(i + 1);
+}
+
+
 /*
  * Allocate a new monster list based on the size of the current cave's monster
  * array.
@@ -42,6 +137,7 @@ monster_list_t *monster_list_new(struct player *p)
 	}
 
 	list->entries_size = size;
+    list->race_entries = mem_zalloc(z_info->r_max * sizeof(u16b));
 
 	return list;
 }
@@ -60,6 +156,7 @@ void monster_list_free(monster_list_t *list)
 		list->entries = NULL;
 	}
 
+    mem_free(list->race_entries);
 	mem_free(list);
 	list = NULL;
 }
@@ -124,6 +221,7 @@ void monster_list_reset(struct player *p, monster_list_t *list)
     }
 
     memset(list->entries, 0, list->entries_size * sizeof(monster_list_entry_t));
+    memset(list->race_entries, 0, z_info->r_max * sizeof(u16b));
     memset(list->total_entries, 0, MONSTER_LIST_SECTION_MAX * sizeof(u16b));
     memset(list->total_monsters, 0, MONSTER_LIST_SECTION_MAX * sizeof(u16b));
     list->distinct_entries = 0;
@@ -136,45 +234,45 @@ void monster_list_reset(struct player *p, monster_list_t *list)
  */
 void monster_list_collect(struct player *p, monster_list_t *list)
 {
-	int i;
+	int i, k, used;
     struct chunk *c = chunk_get(&p->wpos);
 
 	if (!monster_list_can_update(list, c)) return;
 
-	/* Use cave_monster_max() here in case the monster list isn't compacted. */
-	for (i = 1; i < cave_monster_max(c); i++)
+    /* Entries already in use */
+    for (used = 0; (used < (int)list->entries_size) && list->entries[used].race; used++) ;
+
+    /* Only go through the monsters seen by the player */
+    monster_list_prune(p, c);
+	for (k = 0; k < p->mon_seen_num; k++)
     {
-		struct monster *mon = cave_monster(c, i);
+		struct monster *mon;
 		monster_list_entry_t *entry = NULL;
-		int j, field;
+		int field;
 		bool los = false;
 
-        /* Skip dead monsters */
-        if (!mon->race) continue;
+        i = p->mon_seen[k];
+        mon = cave_monster(c, i);
 
 		/* Only consider visible, known monsters */
         if (!monster_is_obvious(p, i, mon)) continue;
 
 		/* Find or add a list entry. */
-		for (j = 0; j < (int)list->entries_size; j++)
+        if (list->race_entries[mon->race->ridx])
+        {
+            /* We found a matching race and we'll use that. */
+            entry = &list->entries[list->race_entries[mon->race->ridx] - 1];
+        }
+        else
         {
-			if (list->entries[j].race == NULL)
-            {
-				/* We found an empty slot, so add this race here. */
-                entry = &list->entries[j];
-                memset(entry, 0, sizeof(monster_list_entry_t));
-				entry->race = mon->race;
-				break;
-			}
-			else if (list->entries[j].race == mon->race)
-            {
-				/* We found a matching race and we'll use that. */
-				entry = &list->entries[j];
-				break;
-			}
-		}
-
-		if (entry == NULL) continue;
+            if (used == (int)list->entries_size) continue;
+
+            /* Add this race in the next empty slot. */
+            entry = &list->entries[used++];
+            memset(entry, 0, sizeof(monster_list_entry_t));
+            entry->race = mon->race;
+            list->race_entries[mon->race->ridx] = (u16b)used;
+        }
 
         /* Always collect the latest monster attribute so that flicker animation works. */
         if (p->tile_distorted)
@@ -184,9 +282,9 @@ void monster_list_collect(struct player *p, monster_list_t *list)
         else
             entry->attr = p->r_attr[mon->race->ridx];
 
-		/* Check for LOS using projectable() */
-		los = (projectable(c, &p->grid, &mon->grid, PROJECT_NONE, true) &&
-            monster_is_in_view(p, i));
+		/* Check for LOS using projectable() (only for monsters in view) */
+		los = (monster_is_in_view(p, i) &&
+            projectable(c, &p->grid, &mon->grid, PROJECT_NONE, true));
 		field = (los? MONSTER_LIST_SECTION_LOS: MONSTER_LIST_SECTION_ESP);
 		entry->count[field]++;
 
@@ -199,10 +297,8 @@ void monster_list_collect(struct player *p, monster_list_t *list)
 	}
 
 	/* Collect totals for easier calculations of the list. */
-	for (i = 0; i < (int)list->entries_size; i++)
+	for (i = 0; i < used; i++)
     {
-		if (list->entries[i].race == NULL) continue;
-
 		if (list->entries[i].count[MONSTER_LIST_SECTION_LOS] > 0)
 			list->total_entries[MONSTER_LIST_SECTION_LOS]++;
 
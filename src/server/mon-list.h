@@ -26,12 +26,17 @@ typedef struct monster_list_s
 {
 	monster_list_entry_t *entries;
 	size_t entries_size;
+    u16b *race_entries;     /* Entry of each race (+1, 0 if none) */
 	u16b distinct_entries;
     bool sorted;
 	u16b total_entries[MONSTER_LIST_SECTION_MAX];
 	u16b total_monsters[MONSTER_LIST_SECTION_MAX];
 } monster_list_t;
 
+extern void monster_list_track(struct player *p, int m_idx);
+extern void monster_list_untrack(struct player *p, int m_idx);
+extern void monster_list_move(struct player *p, int from, int to);
+extern void monster_list_forget(struct player *p);
 extern monster_list_t *monster_list_new(struct player *p);
 extern void monster_list_free(monster_list_t *list);
 extern void monster_list_init(struct player *p);
@@ -132,6 +132,7 @@ static bool clear_vis(struct player *p, struct worldpos *wpos, int m)
     /* Clear some fields */
     mflag_wipe(p->mflag[m]);
     p->mon_det[m] = 0;
+    monster_list_untrack(p, m);
 
     return true;
 }
@@ -303,6 +304,7 @@ static void compact_monsters_aux(struct chunk *c, int i1, int i2)
 
         mflag_copy(p->mflag[i2], p->mflag[i1]);
         p->mon_det[i2] = p->mon_det[i1];
+        monster_list_move(p, i1, i2);
 
         /* Hack -- update the target */
         if (target_equals(p, mon1)) target_set_monster(p, mon2);
@@ -225,8 +225,8 @@ static bool monster_can_hear(struct player *p, struct monster *mon)
  */
 static bool monster_can_smell(struct player *p, struct monster *mon)
 {
-    if (p->cave->scent.grids[mon->grid.y][mon->grid.x] == 0) return false;
-    return ((mon->race->smell > p->cave->scent.grids[mon->grid.y][mon->grid.x])? true: false);
+    if (player_scent(p, &mon->grid) == 0) return false;
+    return ((mon->race->smell > player_scent(p, &mon->grid))? true: false);
 }
 
 
@@ -565,7 +565,7 @@ static int get_max_noise(struct player *p, struct chunk *c, struct monster *mon,
 static int get_best_scent(struct player *p, struct chunk *c, struct monster *mon, struct loc *grid)
 {
     int i;
-    int best_scent = mon->race->smell - p->cave->scent.grids[grid->y][grid->x];
+    int best_scent = mon->race->smell - player_scent(p, grid);
 
     /* Check nearby scent, giving preference to the cardinal directions */
     for (i = 0; i < 8; i++)
@@ -579,10 +579,10 @@ static int get_best_scent(struct player *p, struct chunk *c, struct monster *mon
         /* Bounds check */
         if (!square_in_bounds(c, &a_grid)) continue;
 
-        smelled_scent = mon->race->smell - p->cave->scent.grids[a_grid.y][a_grid.x];
+        smelled_scent = mon->race->smell - player_scent(p, &a_grid);
 
         /* Must be some scent */
-        if (p->cave->scent.grids[a_grid.y][a_grid.x] == 0) continue;
+        if (player_scent(p, &a_grid) == 0) continue;
 
         /* There's a monster blocking that we can't deal with */
         if (!monster_can_kill(c, mon, &a_grid) && !monster_can_move(c, mon, &a_grid))
@@ -616,10 +616,10 @@ static int get_max_scent(struct player *p, struct chunk *c, struct monster *mon,
         /* Bounds check */
         if (!square_in_bounds(c, &grid)) continue;
 
-        smelled_scent = mon->race->smell - p->cave->scent.grids[grid.y][grid.x];
+        smelled_scent = mon->race->smell - player_scent(p, &grid);
 
         /* Must be some scent */
-        if (p->cave->scent.grids[grid.y][grid.x] == 0) continue;
+        if (player_scent(p, &grid) == 0) continue;
 
         /* There's a monster blocking that we can't deal with */
         if (!monster_can_kill(c, mon, &grid) && !monster_can_move(c, mon, &grid))
@@ -783,10 +783,10 @@ static bool get_move_advance(struct player *p, struct chunk *c, struct monster *
         /* Bounds check */
         if (!square_in_bounds(c, &grid)) continue;
 
-        smelled_scent = mon->race->smell - p->cave->scent.grids[grid.y][grid.x];
+        smelled_scent = mon->race->smell - player_scent(p, &grid);
 
         /* Must be some scent */
-        if (p->cave->scent.grids[grid.y][grid.x] == 0) continue;
+        if (player_scent(p, &grid) == 0) continue;
 
         /* There's a monster blocking that we can't deal with */
         if (!monster_can_kill(c, mon, &grid) && !monster_can_move(c, mon, &grid))
@@ -2432,20 +2432,18 @@ static void regen_monster(struct monster *mon)
  */
 static void get_closest_player(struct chunk *c, struct monster *mon)
 {
-    int i;
+    int i, n;
     struct player *closest = NULL;
     int dis_to_closest = 9999, lowhp = 9999;
     bool blos = false, new_los;
 
-    /* Check for each player */
-    for (i = 1; i <= NumPlayers; i++)
+    /* Check for each player on the level */
+    n = cave_player_count(c);
+    for (i = 0; i < n; i++)
     {
-        struct player *p = player_get(i);
+        struct player *p = cave_player(c, i);
         int d;
 
-        /* Make sure he's on the same dungeon level */
-        if (!wpos_eq(&p->wpos, &mon->wpos)) continue;
-
         /* Hack -- skip him if he's shopping */
         if (in_store(p)) continue;
 
@@ -2511,7 +2509,7 @@ static void get_closest_player(struct chunk *c, struct monster *mon)
  */
 void process_monsters(struct chunk *c, bool more_energy)
 {
-    int i, j, time;
+    int i, j, n, time;
 
     /* Only process some things every so often */
     bool regen;
@@ -2634,13 +2632,11 @@ void process_monsters(struct chunk *c, bool more_energy)
         if (!mon->race) continue;
         if (!monster_shimmer(mon->race)) continue;
 
-        /* Check everyone */
-        for (j = 1; j <= NumPlayers; j++)
+        /* Check everyone on the level */
+        n = cave_player_count(c);
+        for (j = 0; j < n; j++)
         {
-            struct player *q = player_get(j);
-
-            /* If he's not here, skip him */
-            if (!wpos_eq(&q->wpos, &mon->wpos)) continue;
+            struct player *q = cave_player(c, j);
 
             /* Actually light that spot for that player */
             if (allow_shimmer(q)) square_light_spot_aux(q, c, &mon->grid);
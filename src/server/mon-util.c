@@ -406,6 +406,9 @@ static void update_mon_aux(struct player *p, struct monster *mon, struct chunk *
     /* The monster is now visible */
     if (flag)
     {
+        /* Add it to the monster list (also needed if it was marked visible on a previous level) */
+        monster_list_track(p, mon->midx);
+
         /* Learn about the monster's mind */
         if (basic)
         {
@@ -495,7 +498,7 @@ static void update_mon_aux(struct player *p, struct monster *mon, struct chunk *
 
 void update_mon(struct monster *mon, struct chunk *c, bool full)
 {
-    int i;
+    int i, n;
     bool blos = false;
     struct player *closest = NULL;
     int dis_to_closest = 9999, lowhp = 9999;
@@ -505,13 +508,11 @@ void update_mon(struct monster *mon, struct chunk *c, bool full)
     my_assert(mon != NULL);
     source_monster(who, mon);
 
-    /* Check for each player */
-    for (i = 1; i <= NumPlayers; i++)
+    /* Check for each player on the level */
+    n = cave_player_count(c);
+    for (i = 0; i < n; i++)
     {
-        struct player *p = player_get(i);
-
-        /* Make sure he's on the same dungeon level */
-        if (!wpos_eq(&p->wpos, &mon->wpos)) continue;
+        struct player *p = cave_player(c, i);
 
         update_mon_aux(p, mon, c, full, &blos, &dis_to_closest, &closest, &lowhp);
     }
@@ -1449,6 +1450,7 @@ static void update_player_aux(struct player *p, struct player *q, struct chunk *
     int d, d_esp;
     int id = get_player_index(get_connection(q->conn));
     struct loc grid1, grid2;
+    struct player_vis *v = player_vis_get(p, q, false);
 
     /* Seen at all */
     bool flag = false;
@@ -1474,7 +1476,7 @@ static void update_player_aux(struct player *p, struct player *q, struct chunk *
     if (d_esp > 255) d_esp = 255;
 
     /* Detected */
-    if (p->play_det[id]) flag = true;
+    if (v && v->det) flag = true;
 
     /* Check if telepathy works */
     if (square_isno_esp(c, &q->grid) || square_isno_esp(c, &p->grid))
@@ -1585,7 +1587,8 @@ static void update_player_aux(struct player *p, struct player *q, struct chunk *
         if (!player_is_visible(p, id))
         {
             /* Mark as visible */
-            mflag_on(p->pflag[id], MFLAG_VISIBLE);
+            if (!v) v = player_vis_get(p, q, true);
+            mflag_on(v->mflag, MFLAG_VISIBLE);
 
             /* Draw the player */
             square_light_spot_aux(p, c, &q->grid);
@@ -1616,7 +1619,7 @@ static void update_player_aux(struct player *p, struct player *q, struct chunk *
         if (player_is_visible(p, id))
         {
             /* Mark as not visible */
-            mflag_off(p->pflag[id], MFLAG_VISIBLE);
+            mflag_off(v->mflag, MFLAG_VISIBLE);
 
             /* Erase the player */
             square_light_spot_aux(p, c, &q->grid);
@@ -1630,7 +1633,8 @@ static void update_player_aux(struct player *p, struct player *q, struct chunk *
         if (!player_is_in_view(p, id))
         {
             /* Mark as easily visible */
-            mflag_on(p->pflag[id], MFLAG_VIEW);
+            if (!v) v = player_vis_get(p, q, true);
+            mflag_on(v->mflag, MFLAG_VIEW);
 
             /* Disturb on appearance (except friendlies and hidden mimics) */
             if (OPT(p, disturb_near) && pvp_check(p, q, PVP_CHECK_ONE, true, 0x00) && !q->k_idx &&
@@ -1649,7 +1653,7 @@ static void update_player_aux(struct player *p, struct player *q, struct chunk *
         if (player_is_in_view(p, id))
         {
             /* Mark as not easily visible */
-            mflag_off(p->pflag[id], MFLAG_VIEW);
+            mflag_off(v->mflag, MFLAG_VIEW);
         }
     }
 }
@@ -1658,39 +1662,49 @@ static void update_player_aux(struct player *p, struct player *q, struct chunk *
 /*
  * This function updates the visibility flags for everyone who may see
  * this player.
+ *
+ * Only players on the same level are checked: players on other levels have already
+ * forgotten about this player (see forget_player()).
  */
 void update_player(struct player *q)
 {
-    int i, id = get_player_index(get_connection(q->conn));
+    int i, n;
+    struct chunk *c = chunk_get(&q->wpos);
     struct source who_body;
     struct source *who = &who_body;
 
     /* Efficiency -- clear "shimmer" flag */
     q->shimmer = false;
 
-    /* Check for every other player */
-    for (i = 1; i <= NumPlayers; i++)
+    /* Check for every other player on this level (unless still changing level) */
+    n = ((c && !q->upkeep->limbo)? cave_player_count(c): 0);
+    for (i = 0; i < n; i++)
     {
-        struct player *p = player_get(i);
-
-        /* Skip players not on this level */
-        if (!wpos_eq(&p->wpos, &q->wpos))
-        {
-            mflag_wipe(p->pflag[id]);
-            p->play_det[id] = 0;
-            continue;
-        }
+        struct player *p = cave_player(c, i);
 
         /* Player can always see himself */
         if (q == p) continue;
 
-        update_player_aux(p, q, chunk_get(&p->wpos));
+        update_player_aux(p, q, c);
     }
 
     source_player(who, 0, q);
     update_cursor(who);
 }
 
+/*
+ * Forget what a player and everyone else know about each other, when the player leaves
+ * the level or the game.
+ */
+void forget_player(struct player *q)
+{
+    int i;
+
+    for (i = 1; i <= NumPlayers; i++) player_vis_forget(player_get(i), q);
+    q->play_vis_num = 0;
+}
+
+
 /*
  * This function simply updates all the players (see above).
  */
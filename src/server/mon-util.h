@@ -42,6 +42,7 @@ extern bool mon_take_hit(struct player *p, struct chunk *c, struct monster *mon,
     bool *fear, int note);
 extern void monster_take_terrain_damage(struct chunk *c, struct monster *mon);
 extern void update_player(struct player *q);
+extern void forget_player(struct player *q);
 extern void update_players(void);
 extern bool is_humanoid(const struct monster_race *race);
 extern bool is_half_humanoid(const struct monster_race *race);
@@ -0,0 +1,227 @@
+/*
+ * File: net-queue.c
+ * Purpose: Output queues of the connections
+ *
+ * Copyright (c) 2019 MAngband and PWMAngband Developers
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+
+#include "s-angband.h"
+
+
+/*
+ * Whatever the socket doesn't accept right away is appended to the output queue of the
+ * connection, a chain of fixed size blocks. The queue is drained (several blocks per
+ * system call) as soon as the socket becomes writable again, so a burst of data (level
+ * change, full map) no longer needs to fit in the socket buffer at once.
+ *
+ * Drained blocks are kept on a free list for reuse.
+ */
+
+
+/* Maximum number of blocks kept on the free list */
+#define OUTQ_SPARE_MAX  64
+
+
+static struct outq_block *outq_spare;
+static int outq_spare_num;
+
+
+static struct outq_block *outq_block_new(void)
+{
+    struct outq_block *block = outq_spare;
+
+    if (block)
+    {
+        outq_spare = block->next;
+        outq_spare_num--;
+    }
+    else
+        block = mem_alloc(sizeof(*block));
+
+    block->next = NULL;
+    block->start = 0;
+    block->end = 0;
+
+    return block;
+}
+
+
+static void outq_block_free(struct outq_block *block)
+{
+    if (outq_spare_num >= OUTQ_SPARE_MAX)
+    {
+        mem_free(block);
+        return;
+    }
+
+    block->next = outq_spare;
+    outq_spare = block;
+    outq_spare_num++;
+}
+
+
+/*
+ * Append data to the queue
+ */
+static void outq_push(struct out_queue *oq, char *buf, int len)
+{
+    oq->len += len;
+    if (oq->len > oq->peak) oq->peak = oq->len;
+
+    while (len > 0)
+    {
+        int n;
+
+        if (!oq->tail || (oq->tail->end == OUTQ_BLOCK_SIZE))
+        {
+            struct outq_block *block = outq_block_new();
+
+            if (oq->tail) oq->tail->next = block;
+            else oq->head = block;
+            oq->tail = block;
+        }
+
+        n = MIN(len, OUTQ_BLOCK_SIZE - oq->tail->end);
+        memcpy(oq->tail->data + oq->tail->end, buf, n);
+        oq->tail->end += n;
+        buf += n;
+        len -= n;
+    }
+}
+
+
+/*
+ * Write as much of the queue as the socket accepts
+ *
+ * Returns the number of bytes written, or -1 on error.
+ */
+int outq_flush(struct out_queue *oq, int sock)
+{
+    char *bufs[DGRAM_IOV_MAX];
+    int sizes[DGRAM_IOV_MAX];
+    int total = 0;
+
+    while (oq->head)
+    {
+        struct outq_block *block;
+        int count = 0, len;
+
+        for (block = oq->head; block && (count < DGRAM_IOV_MAX); block = block->next)
+        {
+            bufs[count] = block->data + block->start;
+            sizes[count] = block->end - block->start;
+            count++;
+        }
+
+        errno = 0;
+        len = DgramWriteV(sock, bufs, sizes, count);
+        if (len <= 0)
+        {
+            if (errno == EINTR) continue;
+            if ((len == 0) || (errno == EWOULDBLOCK) || (errno == EAGAIN)) break;
+            plog("Can't write on socket");
+            return -1;
+        }
+        total += len;
+        oq->len -= len;
+
+        /* Release the blocks that have been sent */
+        while (len > 0)
+        {
+            block = oq->head;
+            if (len < block->end - block->start)
+            {
+                block->start += len;
+                break;
+            }
+            len -= block->end - block->start;
+            oq->head = block->next;
+            if (!oq->head) oq->tail = NULL;
+            outq_block_free(block);
+        }
+    }
+
+    return total;
+}
+
+
+/*
+ * Send data: directly if nothing is waiting, or after what's already in the queue
+ *
+ * Returns the number of bytes written to the socket, or -1 on error.
+ */
+int outq_send(struct out_queue *oq, int sock, char *buf, int len)
+{
+    int written = 0;
+
+    if (!oq->head)
+    {
+        while (written < len)
+        {
+            int n;
+
+            errno = 0;
+            n = DgramWrite(sock, buf + written, len - written);
+            if (n <= 0)
+            {
+                if (errno == EINTR) continue;
+                if ((n == 0) || (errno == EWOULDBLOCK) || (errno == EAGAIN)) break;
+                plog("Can't write on socket");
+                return -1;
+            }
+            written += n;
+        }
+
+        /* Keep the rest for later */
+        if (written < len) outq_push(oq, buf + written, len - written);
+
+        return written;
+    }
+
+    outq_push(oq, buf, len);
+    return outq_flush(oq, sock);
+}
+
+
+/*
+ * Forget everything in the queue
+ */
+void outq_wipe(struct out_queue *oq)
+{
+    while (oq->head)
+    {
+        struct outq_block *block = oq->head;
+
+        oq->head = block->next;
+        outq_block_free(block);
+    }
+    memset(oq, 0, sizeof(*oq));
+}
+
+
+/*
+ * Free the spare blocks
+ */
+void outq_cleanup(void)
+{
+    while (outq_spare)
+    {
+        struct outq_block *block = outq_spare;
+
+        outq_spare = block->next;
+        mem_free(block);
+    }
+    outq_spare_num = 0;
+}
@@ -0,0 +1,36 @@
+/*
+ * File: net-queue.h
+ * Purpose: Output queues of the connections
+ */
+
+#ifndef INCLUDED_NET_QUEUE_H
+#define INCLUDED_NET_QUEUE_H
+
+/* Size of a block of the output queue */
+#define OUTQ_BLOCK_SIZE     16384
+
+struct outq_block
+{
+    struct outq_block *next;
+    int start;                      /* First byte not sent yet */
+    int end;                        /* End of the data */
+    char data[OUTQ_BLOCK_SIZE];
+};
+
+/*
+ * Data waiting for the socket to accept it, as a chain of blocks
+ */
+struct out_queue
+{
+    struct outq_block *head;
+    struct outq_block *tail;
+    size_t len;                     /* Bytes in the queue */
+    size_t peak;                    /* Largest size reached */
+};
+
+extern int outq_send(struct out_queue *oq, int sock, char *buf, int len);
+extern int outq_flush(struct out_queue *oq, int sock);
+extern void outq_wipe(struct out_queue *oq);
+extern void outq_cleanup(void);
+
+#endif /* INCLUDED_NET_QUEUE_H */
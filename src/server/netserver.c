@@ -92,11 +92,14 @@
 #define MAX_TEXTFILE_CHUNK              512
 
 
-static server_setup_t Setup;
 static int login_in_progress;
 static int num_logins, num_logouts;
 
 
+/* Traffic of all the connections */
+static u64b net_bytes_raw, net_bytes_sent, net_deflate_time;
+
+
 /* The contact socket */
 static int Socket;
 static sockbuf_t ibuf;
@@ -161,6 +164,139 @@ void set_player_index(connection_t *connp, long idx)
 }
 
 
+/*
+ * A compact list of the connections in use (not CONN_FREE), so the few iterations over
+ * connections don't need to look at every slot
+ */
+static int conn_active[MAX_PLAYERS];
+static int conn_active_num;
+
+
+int Conn_active_num(void)
+{
+    return conn_active_num;
+}
+
+
+int Conn_active(int i)
+{
+    return conn_active[i];
+}
+
+
+static void conn_active_add(connection_t *connp)
+{
+    connp->active_pos = conn_active_num + 1;
+    conn_active[conn_active_num++] = (int)(connp - Conn);
+}
+
+
+static void conn_active_del(connection_t *connp)
+{
+    int pos = connp->active_pos - 1;
+
+    /* Move the last one into the hole */
+    conn_active[pos] = conn_active[--conn_active_num];
+    get_connection(conn_active[pos])->active_pos = pos + 1;
+    connp->active_pos = 0;
+}
+
+
+/*
+ * Connection deadlines
+ *
+ * The connections that can time out are kept in a binary min-heap, ordered by the turn at
+ * which they would time out if nothing happened. Receiving a packet only refreshes
+ * connp->start: when a deadline comes, the real one is computed again, and either the
+ * connection is destroyed or its deadline is pushed back. So each frame only looks at the
+ * connections that are (maybe) expiring.
+ */
+static int conn_heap[MAX_PLAYERS];
+static int conn_heap_num;
+
+
+/*
+ * First turn at which a connection is considered timed out
+ */
+static void conn_deadline(connection_t *connp, hturn *deadline)
+{
+    ht_copy(deadline, &connp->start);
+    ht_add(deadline, (u32b)(connp->timeout * cfg_fps) + 1);
+}
+
+
+static void conn_heap_set(int pos, int ind)
+{
+    conn_heap[pos] = ind;
+    get_connection(ind)->heap_pos = pos + 1;
+}
+
+
+static bool conn_heap_less(int pos1, int pos2)
+{
+    return (ht_cmp(&get_connection(conn_heap[pos1])->deadline,
+        &get_connection(conn_heap[pos2])->deadline) < 0);
+}
+
+
+/*
+ * Restore the heap order around a position
+ */
+static void conn_heap_fix(int pos)
+{
+    int ind = conn_heap[pos];
+
+    /* Move up */
+    while (pos > 0)
+    {
+        int parent = (pos - 1) / 2;
+
+        if (!conn_heap_less(pos, parent)) break;
+        conn_heap_set(pos, conn_heap[parent]);
+        conn_heap_set(parent, ind);
+        pos = parent;
+    }
+
+    /* Move down */
+    while (true)
+    {
+        int child = pos * 2 + 1;
+
+        if (child >= conn_heap_num) break;
+        if ((child + 1 < conn_heap_num) && conn_heap_less(child + 1, child)) child++;
+        if (!conn_heap_less(child, pos)) break;
+        conn_heap_set(pos, conn_heap[child]);
+        conn_heap_set(child, ind);
+        pos = child;
+    }
+}
+
+
+/*
+ * Add a connection to the heap, or move it after its deadline changed
+ */
+static void conn_heap_update(connection_t *connp)
+{
+    conn_deadline(connp, &connp->deadline);
+
+    if (!connp->heap_pos) conn_heap_set(conn_heap_num++, (int)(connp - Conn));
+    conn_heap_fix(connp->heap_pos - 1);
+}
+
+
+static void conn_heap_del(connection_t *connp)
+{
+    int pos = connp->heap_pos - 1;
+
+    connp->heap_pos = 0;
+    if (pos == --conn_heap_num) return;
+
+    /* Move the last one into the hole */
+    conn_heap_set(pos, conn_heap[conn_heap_num]);
+    conn_heap_fix(pos);
+}
+
+
 /*** General utilities ***/
 
 
@@ -171,6 +307,8 @@ int Setup_net_server(void)
 {
     if (Init_setup() == -1) return -1;
 
+    if (!accounts_init()) return -1;
+
     init_connections();
 
     init_players();
@@ -205,6 +343,95 @@ void Conn_set_state(connection_t *connp, int state, long timeout)
 
     if (timeout) connp->timeout = timeout;
     login_in_progress = num_conn_busy - num_conn_playing;
+
+    /* Track the connections in use */
+    if ((connp->state == CONN_FREE) && connp->active_pos) conn_active_del(connp);
+    else if ((connp->state != CONN_FREE) && !connp->active_pos) conn_active_add(connp);
+
+    /* Track the connections that can time out */
+    if ((connp->state == CONN_FREE) || (connp->state == CONN_CONSOLE))
+    {
+        if (connp->heap_pos) conn_heap_del(connp);
+    }
+    else
+        conn_heap_update(connp);
+}
+
+
+/*
+ * Add the content of the reliable buffer to the write buffer, as a frame (compressed if
+ * large enough) if the client asked for compression
+ *
+ * Returns the number of bytes added, or -1 on error.
+ */
+static int Write_frame(connection_t *connp)
+{
+    int len = connp->c.len, written;
+    u64b start;
+
+    if (!len) return 0;
+
+    if (!connp->deflate)
+    {
+        written = Sockbuf_write(&connp->w, connp->c.buf, len);
+        if (written != len) return -1;
+    }
+    else if (len < cfg_compress_min_size)
+        written = net_raw(&connp->w, connp->c.buf, len);
+    else
+    {
+        start = profile_ticks();
+        written = net_deflate(connp->deflate, &connp->w, connp->c.buf, len);
+        connp->deflate_time += profile_ticks() - start;
+        net_deflate_time += profile_ticks() - start;
+    }
+    if (written < 0) return -1;
+
+    connp->bytes_raw += len;
+    connp->bytes_sent += written;
+    net_bytes_raw += len;
+    net_bytes_sent += written;
+
+    return written;
+}
+
+
+/*
+ * Describe the traffic of a connection
+ */
+void Conn_describe_traffic(int ind, char *buf, size_t len)
+{
+    connection_t *connp = get_connection(ind);
+
+    strnfmt(buf, len,
+        "Sent %lu KB (%lu KB before compression), %lu ms compressing, %lu KB queued (peak %lu KB)",
+        (unsigned long)(connp->bytes_sent / 1024), (unsigned long)(connp->bytes_raw / 1024),
+        (unsigned long)(connp->deflate_time / 1000000), (unsigned long)(connp->oq.len / 1024),
+        (unsigned long)(connp->oq.peak / 1024));
+}
+
+
+/*
+ * Describe the traffic of all connections
+ */
+void Net_describe_traffic(char *buf, size_t len)
+{
+    size_t queued = 0;
+    int i, congested = 0;
+
+    for (i = 0; i < conn_active_num; i++)
+    {
+        connection_t *connp = get_connection(conn_active[i]);
+
+        queued += connp->oq.len;
+        if (Conn_is_congested(conn_active[i])) congested++;
+    }
+
+    strnfmt(buf, len,
+        "Network: %lu KB sent, %lu KB before compression (%lu%%), %lu ms compressing, %lu KB queued (%d congested)",
+        (unsigned long)(net_bytes_sent / 1024), (unsigned long)(net_bytes_raw / 1024),
+        (unsigned long)(net_bytes_raw? net_bytes_sent * 100 / net_bytes_raw: 100),
+        (unsigned long)(net_deflate_time / 1000000), (unsigned long)(queued / 1024), congested);
 }
 
 
@@ -237,6 +464,8 @@ static void do_quit(int ind)
 
     /* Disable all output and input to and from this player */
     connp->w.sock = -1;
+    outq_wipe(&connp->oq);
+    connp->oq_watch = false;
 
     /* Check for immediate disconnection */
     if (town_area(&wpos) || dungeon_master)
@@ -254,6 +483,58 @@ static void do_quit(int ind)
 }
 
 
+static void Handle_output(int fd, int arg);
+
+
+/*
+ * Wait for the socket to become writable while there is something in the output queue
+ */
+static void Watch_output(int ind)
+{
+    connection_t *connp = get_connection(ind);
+
+    if (connp->oq.head && !connp->oq_watch)
+    {
+        install_output(Handle_output, connp->w.sock, ind);
+        connp->oq_watch = true;
+    }
+    else if (!connp->oq.head && connp->oq_watch)
+    {
+        remove_output(connp->w.sock);
+        connp->oq_watch = false;
+    }
+}
+
+
+/*
+ * The socket is writable again: drain the output queue
+ */
+static void Handle_output(int fd, int arg)
+{
+    int ind = arg;
+    connection_t *connp = get_connection(ind);
+
+    if (outq_flush(&connp->oq, fd) < 0)
+    {
+        Destroy_connection(ind, "Cannot flush reliable data");
+        return;
+    }
+
+    Watch_output(ind);
+}
+
+
+/*
+ * True if the output queue of a connection is above the high-water mark
+ */
+bool Conn_is_congested(int ind)
+{
+    connection_t *connp = get_connection(ind);
+
+    return (connp->oq.len > (size_t)cfg_output_queue_high * 1024);
+}
+
+
 static int Send_reliable(int ind)
 {
     connection_t *connp = get_connection(ind);
@@ -263,21 +544,45 @@ static int Send_reliable(int ind)
      * Hack -- make sure we have a valid socket to write to.
      * -1 is used to specify a player that has disconnected but is still "in game".
      */
-    if (connp->w.sock == -1) return 0;
+    if (connp->w.sock == -1)
+    {
+        /* Benchmark bots have no socket: count the data (and compress it) and discard it */
+        if (bench_turns)
+        {
+            bench_sent(connp->c.len);
+            Write_frame(connp);
+            Sockbuf_clear(&connp->w);
+            Sockbuf_clear(&connp->c);
+        }
+        return 0;
+    }
 
-    if ((num_written = Sockbuf_write(&connp->w, connp->c.buf, connp->c.len)) != connp->c.len)
+    if (Write_frame(connp) < 0)
     {
-        plog_fmt("Cannot write reliable data (%d, %d)", num_written, connp->c.len);
+        plog_fmt("Cannot write reliable data (%d)", connp->c.len);
         Destroy_connection(ind, "Cannot write reliable data");
         return -1;
     }
-    if ((num_written = Sockbuf_flush(&connp->w)) < 0)
+
+    /* Send what the socket accepts, queue the rest */
+    if ((num_written = outq_send(&connp->oq, connp->w.sock, connp->w.buf, connp->w.len)) < 0)
     {
-        plog_fmt("Cannot flush reliable data (%d)", num_written);
+        plog_fmt("Cannot flush reliable data (%d)", connp->w.len);
         Destroy_connection(ind, "Cannot flush reliable data");
         return -1;
     }
+    Sockbuf_clear(&connp->w);
     Sockbuf_clear(&connp->c);
+
+    /* The client doesn't keep up at all */
+    if (connp->oq.len > (size_t)cfg_output_queue_max * 1024)
+    {
+        plog_fmt("Output queue overflow (%lu)", (unsigned long)connp->oq.len);
+        Destroy_connection(ind, "Output queue overflow");
+        return -1;
+    }
+
+    Watch_output(ind);
     return num_written;
 }
 
@@ -357,7 +662,7 @@ static void Handle_input(int fd, int arg)
      */
     if (connp->c.len > 0)
     {
-        if (Packet_printf(&connp->c, "%b", (unsigned)PKT_END) <= 0)
+        if (Packet_put_type(&connp->c, PKT_END) <= 0)
         {
             Destroy_connection(ind, "Net input write error");
             return;
@@ -383,6 +688,32 @@ static u16b get_flavor_max(void)
 }
 
 
+/*
+ * Allocate the visual info of a player connection (only once)
+ */
+static void alloc_client_setup(connection_t *connp)
+{
+    u16b flavor_max;
+
+    if (connp->has_setup) return;
+
+    flavor_max = get_flavor_max();
+
+    connp->Client_setup.k_attr = mem_zalloc(z_info->k_max * sizeof(byte));
+    connp->Client_setup.k_char = mem_zalloc(z_info->k_max * sizeof(char));
+    connp->Client_setup.r_attr = mem_zalloc(z_info->r_max * sizeof(byte));
+    connp->Client_setup.r_char = mem_zalloc(z_info->r_max * sizeof(char));
+    connp->Client_setup.f_attr = mem_zalloc(z_info->f_max * sizeof(byte_lit));
+    connp->Client_setup.f_char = mem_zalloc(z_info->f_max * sizeof(char_lit));
+    connp->Client_setup.t_attr = mem_zalloc(z_info->trap_max * sizeof(byte_lit));
+    connp->Client_setup.t_char = mem_zalloc(z_info->trap_max * sizeof(char_lit));
+    connp->Client_setup.flvr_x_attr = mem_zalloc(flavor_max * sizeof(byte));
+    connp->Client_setup.flvr_x_char = mem_zalloc(flavor_max * sizeof(char));
+    connp->Client_setup.note_aware = mem_zalloc(z_info->k_max * sizeof(char_note));
+    connp->has_setup = true;
+}
+
+
 /*
  * After a TCP "Contact" was made we shall see if we have
  * room for more connections and create one.
@@ -394,18 +725,14 @@ static int Setup_connection(u32b account, char *real, char *nick, char *addr, ch
     connection_t *connp;
     bool memory_error = false;
 
-    for (i = 0; i < MAX_PLAYERS; i++)
+    /* Find a free slot (all slots are in use if the list of connections is full) */
+    for (i = 0; (i < MAX_PLAYERS) && (conn_active_num < MAX_PLAYERS); i++)
     {
-        connp = get_connection(i);
-        if (connp->state == CONN_FREE)
+        if (get_connection(i)->state == CONN_FREE)
         {
-            if (free_conn_index == MAX_PLAYERS)
-                free_conn_index = i;
-            continue;
+            free_conn_index = i;
+            break;
         }
-
-        if ((connp->state == CONN_CONSOLE) || (conntype == CONNTYPE_CONSOLE))
-            continue;
     }
 
     if (free_conn_index >= MAX_PLAYERS)
@@ -435,7 +762,7 @@ static int Setup_connection(u32b account, char *real, char *nick, char *addr, ch
     if (SetSocketSendBufferSize(sock, SERVER_SEND_SIZE + 256) == -1)
         plog_fmt("Cannot set send buffer size to %d", SERVER_SEND_SIZE + 256);
 
-    Sockbuf_init(&connp->w, sock, SERVER_SEND_SIZE, SOCKBUF_WRITE);
+    Sockbuf_init(&connp->w, sock, SERVER_SEND_SIZE + FRAME_OVERHEAD, SOCKBUF_WRITE);
     Sockbuf_init(&connp->r, sock, SERVER_RECV_SIZE, SOCKBUF_WRITE | SOCKBUF_READ);
     Sockbuf_init(&connp->c, -1, SERVER_SEND_SIZE, SOCKBUF_WRITE | SOCKBUF_READ | SOCKBUF_LOCK);
     Sockbuf_init(&connp->q, -1, SERVER_RECV_SIZE, SOCKBUF_WRITE | SOCKBUF_READ | SOCKBUF_LOCK);
@@ -461,23 +788,7 @@ static int Setup_connection(u32b account, char *real, char *nick, char *addr, ch
         ht_copy(&connp->start, &turn);
         connp->timeout = SETUP_TIMEOUT;
 
-        if (!connp->has_setup)
-        {
-            u16b flavor_max = get_flavor_max();
-
-            connp->Client_setup.k_attr = mem_zalloc(z_info->k_max * sizeof(byte));
-            connp->Client_setup.k_char = mem_zalloc(z_info->k_max * sizeof(char));
-            connp->Client_setup.r_attr = mem_zalloc(z_info->r_max * sizeof(byte));
-            connp->Client_setup.r_char = mem_zalloc(z_info->r_max * sizeof(char));
-            connp->Client_setup.f_attr = mem_zalloc(z_info->f_max * sizeof(byte_lit));
-            connp->Client_setup.f_char = mem_zalloc(z_info->f_max * sizeof(char_lit));
-            connp->Client_setup.t_attr = mem_zalloc(z_info->trap_max * sizeof(byte_lit));
-            connp->Client_setup.t_char = mem_zalloc(z_info->trap_max * sizeof(char_lit));
-            connp->Client_setup.flvr_x_attr = mem_zalloc(flavor_max * sizeof(byte));
-            connp->Client_setup.flvr_x_char = mem_zalloc(flavor_max * sizeof(char));
-            connp->Client_setup.note_aware = mem_zalloc(z_info->k_max * sizeof(char_note));
-            connp->has_setup = true;
-        }
+        alloc_client_setup(connp);
 
         if ((connp->real == NULL) || (connp->nick == NULL) || (connp->pass == NULL) ||
             (connp->host == NULL))
@@ -497,6 +808,7 @@ static int Setup_connection(u32b account, char *real, char *nick, char *addr, ch
     {
         connp->console_authenticated = false;
         connp->console_listen = false;
+        connp->console_profile = false;
 
         Conn_set_state(connp, CONN_CONSOLE, 0);
     }
@@ -589,7 +901,7 @@ static bool Net_Send(int fd)
 
 static void Contact(int fd, int arg)
 {
-    int newsock, bytes, len, ret;
+    int newsock, bytes, len, ret = -1;
     struct sockaddr_in sin;
     char host_addr[24];
     u16b conntype = 0;
@@ -600,6 +912,8 @@ static void Contact(int fd, int arg)
     int *id_list = NULL;
     u16b num = 0;
     size_t i, j;
+    byte caps = 0;
+    bool has_caps = false;
 
     /*
      * Create a TCP socket for communication with whoever contacted us
@@ -721,6 +1035,14 @@ static void Contact(int fd, int arg)
         nick_name[sizeof(nick_name) - 1] = '\0';
         pass_word[sizeof(pass_word) - 1] = '\0';
 
+        /* Optional capabilities */
+        if (ibuf.ptr < ibuf.buf + ibuf.len)
+        {
+            Packet_scanf(&ibuf, "%b", &caps);
+            has_caps = true;
+        }
+        if (cfg_compress_level <= 0) caps &= ~NET_CAP_DEFLATE;
+
         /* Check if his names are valid */
         if (Check_names(nick_name, real_name, host_name))
             status = E_INVAL;
@@ -756,6 +1078,16 @@ static void Contact(int fd, int arg)
         }
     }
 
+    /* Compress the stream */
+    if (!status && (caps & NET_CAP_DEFLATE))
+    {
+        connection_t *connp = get_connection(ret);
+
+        connp->deflate = net_deflate_new(cfg_compress_level);
+        if (!connp->deflate) caps &= ~NET_CAP_DEFLATE;
+    }
+    if (status) caps = 0;
+
     /* Get characters attached to this account */
     if (!status)
         num = (u16b)player_id_list(&id_list, account);
@@ -806,6 +1138,9 @@ static void Contact(int fd, int arg)
             Packet_printf(&ibuf, "%s", name_sections[i][j]);
     }
 
+    /* Capabilities we agreed on, last so that only clients which sent theirs expect them */
+    if (has_caps) Packet_printf(&ibuf, "%b", (unsigned)caps);
+
     Net_Send(fd);
 
     /* Free the memory in the list */
@@ -820,7 +1155,14 @@ static void Contact(int fd, int arg)
 void setup_contact_socket(void)
 {
     plog("Create TCP socket...");
-    while ((Socket = CreateServerSocket(cfg_tcp_port)) == -1) Sleep(1);
+    while ((Socket = CreateServerSocket(cfg_tcp_port)) == -1)
+    {
+#ifdef WINDOWS
+        Sleep(1);
+#else
+        usleep(1000);
+#endif
+    }
     if (Socket == -2)
         quit("Address is already in use");
     plog("Set Non-Blocking...");
@@ -847,6 +1189,9 @@ bool Report_to_meta(int flag)
     /* Abort if the user doesn't want to report */
     if (!cfg_report_to_meta) return false;
 
+    /* Never report benchmark runs */
+    if (bench_turns) return false;
+
     /* New implementation */
     meta_report(flag);
     return true;
@@ -943,6 +1288,9 @@ static void Delete_player(int id)
         if (source_equal(health_who, who)) health_track(q->upkeep, NULL);
     }
 
+    /* Players forget about the player */
+    forget_player(p);
+
     /* Swap entry number 'id' with the last one */
     /* Also, update the "player_index" on the cave grids */
     if (id != NumPlayers)
@@ -967,6 +1315,7 @@ static void Delete_player(int id)
 
     /* Update the number of players */
     NumPlayers--;
+    cave_players_changed();
 
     /* Tell the metaserver about the loss of a player */
     Report_to_meta(META_UPDATE);
@@ -1056,16 +1405,28 @@ void Destroy_connection(int ind, char *reason)
     {
         if (connp->w.sock != -1)
         {
-            char pkt[NORMAL_WID];
+            char frame[FRAME_HEADER + NORMAL_WID];
+            char *pkt = frame + FRAME_HEADER;
             int len;
 
             pkt[0] = PKT_QUIT;
-            my_strcpy(&pkt[1], reason, sizeof(pkt) - 2);
+            my_strcpy(&pkt[1], reason, NORMAL_WID - 2);
             len = strlen(pkt) + 2;
             pkt[len - 1] = PKT_END;
             pkt[len] = '\0';
 
-            if (DgramWrite(connp->w.sock, pkt, len) != len)
+            /* Compressed stream: send it as a raw frame */
+            if (connp->deflate)
+            {
+                net_frame_header(frame, FRAME_RAW, len);
+                pkt = frame;
+                len += FRAME_HEADER;
+            }
+
+            /* Send it after the pending data */
+            if (connp->oq.head)
+                outq_send(&connp->oq, connp->w.sock, pkt, len);
+            else if (DgramWrite(connp->w.sock, pkt, len) != len)
             {
                 GetSocketError(connp->w.sock);
                 DgramWrite(connp->w.sock, pkt, len);
@@ -1088,6 +1449,8 @@ void Destroy_connection(int ind, char *reason)
     Sockbuf_cleanup(&connp->r);
     Sockbuf_cleanup(&connp->c);
     Sockbuf_cleanup(&connp->q);
+    net_deflate_free(connp->deflate);
+    outq_wipe(&connp->oq);
 
     if (connp->w.sock != -1)
     {
@@ -1129,9 +1492,14 @@ void Stop_net_server(void)
     /* Dealloc player array */
     free_players();
 
+    /* Forget the accounts */
+    accounts_free();
+
     /* Remove listening socket */
     if (Socket != -2) remove_input(Socket);
     Sockbuf_cleanup(&ibuf);
+    net_compress_cleanup();
+    outq_cleanup();
 
     /* Destroy networking */
     free_input();
@@ -1162,8 +1530,12 @@ void Conn_set_console_setting(int ind, int set, bool val)
 {
     connection_t *connp = get_connection(ind);
 
-    if (set) connp->console_authenticated = val;
-    else connp->console_listen = val;
+    switch (set)
+    {
+        case CONSOLE_LISTEN: connp->console_listen = val; break;
+        case CONSOLE_AUTH: connp->console_authenticated = val; break;
+        case CONSOLE_PROFILE: connp->console_profile = val; break;
+    }
 }
 
 
@@ -1171,7 +1543,11 @@ bool Conn_get_console_setting(int ind, int set)
 {
     connection_t *connp = get_connection(ind);
 
-    if (set) return (bool)connp->console_authenticated;
+    switch (set)
+    {
+        case CONSOLE_AUTH: return (bool)connp->console_authenticated;
+        case CONSOLE_PROFILE: return (bool)connp->console_profile;
+    }
     return (bool)connp->console_listen;
 }
 
@@ -2318,6 +2694,8 @@ int Send_state(struct player *p, bool stealthy, bool resting, bool unignoring)
  *
  * "lineref" is a pointer to an attr/char array, and "max_col" is specifying its size
  *
+ * If "buf" is NULL, nothing is sent and only the number of bytes is returned
+ *
  * Note! To sucessfully decode, client MUST use the same "mode"
  */
 static int rle_encode(sockbuf_t* buf, cave_view_type* lineref, int max_col, int mode)
@@ -2357,7 +2735,7 @@ static int rle_encode(sockbuf_t* buf, cave_view_type* lineref, int max_col, int
             a |= 0x8000;
 
             /* Output the info */
-            Packet_printf(buf, "%c%hu%hu", (int)c, (unsigned)a, (unsigned)n);
+            if (buf) Packet_put_cell_run(buf, c, a, n);
 
             /* Start again after the run */
             i = x1 - 1;
@@ -2373,7 +2751,7 @@ static int rle_encode(sockbuf_t* buf, cave_view_type* lineref, int max_col, int
             a |= 0x40;
 
             /* Output the info */
-            Packet_printf(buf, "%c%hu%hu", (int)c, (unsigned)a, (unsigned)n);
+            if (buf) Packet_put_cell_run(buf, c, a, n);
 
             /* Start again after the run */
             i = x1 - 1;
@@ -2386,7 +2764,7 @@ static int rle_encode(sockbuf_t* buf, cave_view_type* lineref, int max_col, int
         else
         {
             /* Output the info */
-            Packet_printf(buf, "%c%hu", (int)c, (unsigned)a);
+            if (buf) Packet_put_cell(buf, c, a);
 
             /* Count bytes */
             b += 3;
@@ -2479,13 +2857,17 @@ int Send_line_info(struct player *p, int y)
     }
 
     /* Put a header on the packet */
-    Packet_printf(&connp->c, "%b%hd%hd", (unsigned)PKT_LINE_INFO, y, screen_wid);
+    Packet_put_line_info(&connp->c, PKT_LINE_INFO, y, screen_wid);
     if (connp2)
-        Packet_printf(&connp2->c, "%b%hd%hd", (unsigned)PKT_LINE_INFO, y, screen_wid2);
+        Packet_put_line_info(&connp2->c, PKT_LINE_INFO, y, screen_wid2);
 
     /* Reset the line counter */
     if (y == -1) return 1;
 
+    /* The whole line is sent */
+    flag_wipe(p->scr_dirty[y], FLAG_SIZE(z_info->dungeon_wid + COL_MAP));
+    flag_wipe(p->link_dirty[y], FLAG_SIZE(z_info->dungeon_wid + COL_MAP));
+
     /* Encode and send the transparency attr/char stream */
     if (p->use_graphics)
         rle_encode(&connp->c, p->trn_info[y], screen_wid, RLE_LARGE);
@@ -2507,7 +2889,7 @@ int Send_remote_line(struct player *p, int y)
     if (connp == NULL) return 0;
 
     /* Packet header */
-    Packet_printf(&connp->c, "%b%hd%hd", (unsigned)PKT_LINE_INFO, y, NORMAL_WID);
+    Packet_put_line_info(&connp->c, PKT_LINE_INFO, y, NORMAL_WID);
 
     /* Packet body */
     rle_encode(&connp->c, p->info[y], NORMAL_WID, DUNGEON_RLE_MODE(p));
@@ -2581,23 +2963,215 @@ int Send_char(struct player *p, struct loc *grid, u16b a, char c, u16b ta, char
 
         if (p_ptr2->use_graphics && (p_ptr2->remote_term == NTERM_WIN_OVERHEAD))
         {
-            Packet_printf(&connp2->c, "%b%b%b%hu%c%hu%c", (unsigned)PKT_CHAR, (unsigned)grid->x,
-                (unsigned)grid->y, (unsigned)a, (int)c, (unsigned)ta, (int)tc);
+            Packet_put_char_tile(&connp2->c, PKT_CHAR, grid->x, grid->y, a, c, ta, tc);
         }
         else
         {
-            Packet_printf(&connp2->c, "%b%b%b%hu%c", (unsigned)PKT_CHAR, (unsigned)grid->x,
-                (unsigned)grid->y, (unsigned)a, (int)c);
+            Packet_put_char(&connp2->c, PKT_CHAR, grid->x, grid->y, a, c);
         }
     }
 
     if (p->use_graphics && (p->remote_term == NTERM_WIN_OVERHEAD))
     {
-        return Packet_printf(&connp->c, "%b%b%b%hu%c%hu%c", (unsigned)PKT_CHAR, (unsigned)grid->x,
-            (unsigned)grid->y, (unsigned)a, (int)c, (unsigned)ta, (int)tc);
+        return Packet_put_char_tile(&connp->c, PKT_CHAR, grid->x, grid->y, a, c, ta, tc);
+    }
+    return Packet_put_char(&connp->c, PKT_CHAR, grid->x, grid->y, a, c);
+}
+
+
+/*
+ * Remember that a grid of the map has changed (the new attr/char must already be in
+ * "scr_info" and "trn_info"), it will be sent at the end of the turn by Send_dirty_chars()
+ */
+void Send_char_later(struct player *p, struct loc *grid)
+{
+    flag_on(p->scr_dirty[grid->y], FLAG_SIZE(z_info->dungeon_wid + COL_MAP),
+        grid->x + FLAG_START);
+    flag_on(p->scr_dirty_rows, FLAG_SIZE(z_info->dungeon_hgt + ROW_MAP + 1),
+        grid->y + FLAG_START);
+
+    /* Also for a player mind-linked to "p" */
+    flag_on(p->link_dirty[grid->y], FLAG_SIZE(z_info->dungeon_wid + COL_MAP),
+        grid->x + FLAG_START);
+    flag_on(p->link_dirty_rows, FLAG_SIZE(z_info->dungeon_hgt + ROW_MAP + 1),
+        grid->y + FLAG_START);
+}
+
+
+/*
+ * Group the changed grids of a line of the map of player "p" into horizontal runs, and
+ * send them to player "q" (either "p" or a player mind-linked to "p"): runs are sent as
+ * PKT_CHAR_RUN packets, single grids as PKT_CHAR packets.
+ *
+ * The changed grids are the ones flagged in "dirty".
+ *
+ * If "connp" is NULL, nothing is sent and only the number of bytes is returned.
+ */
+static int send_dirty_runs(struct player *p, struct player *q, connection_t *connp, int y,
+    bitflag *dirty)
+{
+    size_t size = FLAG_SIZE(z_info->dungeon_wid + COL_MAP);
+    int screen_wid = q->screen_cols / q->tile_wid;
+    bool single = (q->remote_term != NTERM_WIN_OVERHEAD);
+    bool tile = (q->use_graphics && !single);
+    int x1, x2, next, n, b = 0;
+
+    for (x1 = flag_next(dirty, size, FLAG_START);
+        (x1 != FLAG_END) && (x1 - FLAG_START < screen_wid);
+        x1 = flag_next(dirty, size, x2 + 1))
+    {
+        /* Extend the run (sending one unchanged grid is cheaper than a new packet) */
+        for (x2 = x1; !single; x2 = next)
+        {
+            next = flag_next(dirty, size, x2 + 1);
+            if ((next == FLAG_END) || (next - FLAG_START >= screen_wid) || (next > x2 + 2))
+                break;
+        }
+        n = x2 - x1 + 1;
+        x1 -= FLAG_START;
+
+        /* Single grid */
+        if (n == 1)
+        {
+            b += (tile? 9: 6);
+            if (!connp) continue;
+
+            if (tile)
+            {
+                Packet_put_char_tile(&connp->c, PKT_CHAR, x1, y, p->scr_info[y][x1].a,
+                    p->scr_info[y][x1].c, p->trn_info[y][x1].a, p->trn_info[y][x1].c);
+            }
+            else
+            {
+                Packet_put_char(&connp->c, PKT_CHAR, x1, y, p->scr_info[y][x1].a,
+                    p->scr_info[y][x1].c);
+            }
+            continue;
+        }
+
+        /* Run of grids */
+        b += 4;
+        if (connp) Packet_put_char_run(&connp->c, PKT_CHAR_RUN, x1, y, n);
+        if (tile)
+            b += rle_encode(connp? &connp->c: NULL, p->trn_info[y] + x1, n, RLE_LARGE);
+        b += rle_encode(connp? &connp->c: NULL, p->scr_info[y] + x1, n, DUNGEON_RLE_MODE(q));
+    }
+
+    return b;
+}
+
+
+/*
+ * Send the changed grids of a line of the map of player "p" to player "q", either as
+ * horizontal runs or as a whole line, whichever is smaller.
+ *
+ * Return the number of bytes sent.
+ */
+static int send_dirty_line(struct player *p, struct player *q, connection_t *connp, int y,
+    bitflag *dirty)
+{
+    int screen_wid = q->screen_cols / q->tile_wid;
+    int runs = send_dirty_runs(p, q, NULL, y, dirty), line;
+
+    if (!runs) return 0;
+
+    /* Other terminal: only single grids can be sent */
+    if (q->remote_term != NTERM_WIN_OVERHEAD) return send_dirty_runs(p, q, connp, y, dirty);
+
+    /* Cost of the whole line */
+    line = 5 + rle_encode(NULL, p->scr_info[y], screen_wid, DUNGEON_RLE_MODE(q));
+    if (q->use_graphics) line += rle_encode(NULL, p->trn_info[y], screen_wid, RLE_LARGE);
+
+    if (line >= runs) return send_dirty_runs(p, q, connp, y, dirty);
+
+    Packet_put_line_info(&connp->c, PKT_LINE_INFO, y, screen_wid);
+    if (q->use_graphics) rle_encode(&connp->c, p->trn_info[y], screen_wid, RLE_LARGE);
+    rle_encode(&connp->c, p->scr_info[y], screen_wid, DUNGEON_RLE_MODE(q));
+
+    return line;
+}
+
+
+/*
+ * Count the changed grids of the map of player "p" (benchmark only)
+ */
+static int count_dirty_chars(struct player *p)
+{
+    size_t size = FLAG_SIZE(z_info->dungeon_hgt + ROW_MAP + 1);
+    size_t row_size = FLAG_SIZE(z_info->dungeon_wid + COL_MAP);
+    int screen_wid = p->screen_cols / p->tile_wid;
+    int y, x, cells = 0;
+
+    for (y = flag_next(p->scr_dirty_rows, size, FLAG_START); y != FLAG_END;
+        y = flag_next(p->scr_dirty_rows, size, y + 1))
+    {
+        bitflag *dirty = p->scr_dirty[y - FLAG_START];
+
+        for (x = flag_next(dirty, row_size, FLAG_START);
+            (x != FLAG_END) && (x - FLAG_START < screen_wid);
+            x = flag_next(dirty, row_size, x + 1))
+        {
+            cells++;
+        }
+    }
+
+    return cells;
+}
+
+
+/*
+ * Send the grids of the map that have changed since the last call
+ */
+void Send_dirty_chars(struct player *p)
+{
+    size_t size = FLAG_SIZE(z_info->dungeon_hgt + ROW_MAP + 1);
+    size_t row_size = FLAG_SIZE(z_info->dungeon_wid + COL_MAP);
+    connection_t *connp, *connp2;
+    struct player *p_ptr2 = NULL;
+    int y, cells = 0, bytes = 0, single;
+
+    /* A player mind-linked to "p" gets the changes whatever "p" is looking at */
+    if (!flag_is_empty(p->link_dirty_rows, size))
+    {
+        connp2 = get_mind_link(p);
+        if (connp2 && (connp2->state == CONN_PLAYING)) p_ptr2 = find_player(p->esp_link);
+
+        for (y = flag_next(p->link_dirty_rows, size, FLAG_START); y != FLAG_END;
+            y = flag_next(p->link_dirty_rows, size, y + 1))
+        {
+            int row = y - FLAG_START;
+
+            if (p_ptr2) send_dirty_line(p, p_ptr2, connp2, row, p->link_dirty[row]);
+            flag_wipe(p->link_dirty[row], row_size);
+        }
+        flag_wipe(p->link_dirty_rows, size);
+    }
+
+    if (flag_is_empty(p->scr_dirty_rows, size)) return;
+
+    /* Wait until the map is displayed again */
+    if (p->remote_term != NTERM_WIN_OVERHEAD) return;
+
+    connp = get_connection(p->conn);
+    if (bench_turns && (connp->state == CONN_PLAYING)) cells = count_dirty_chars(p);
+
+    for (y = flag_next(p->scr_dirty_rows, size, FLAG_START); y != FLAG_END;
+        y = flag_next(p->scr_dirty_rows, size, y + 1))
+    {
+        int row = y - FLAG_START;
+
+        if (connp->state == CONN_PLAYING)
+            bytes += send_dirty_line(p, p, connp, row, p->scr_dirty[row]);
+        flag_wipe(p->scr_dirty[row], row_size);
+    }
+    flag_wipe(p->scr_dirty_rows, size);
+
+    /* Report to the benchmark what the grids would have cost as single PKT_CHAR packets */
+    if (bench_turns)
+    {
+        single = cells * ((p->use_graphics && (p->remote_term == NTERM_WIN_OVERHEAD))? 9: 6);
+        bench_map(cells, bytes, single);
     }
-    return Packet_printf(&connp->c, "%b%b%b%hu%c", (unsigned)PKT_CHAR, (unsigned)grid->x,
-        (unsigned)grid->y, (unsigned)a, (int)c);
 }
 
 
@@ -2713,7 +3287,7 @@ int Send_mini_map(struct player *p, int y, s16b w)
     if (connp == NULL) return 0;
 
     /* Packet header */
-    Packet_printf(&connp->c, "%b%hd%hd", (unsigned)PKT_MINI_MAP, y, (int)w);
+    Packet_put_line_info(&connp->c, PKT_MINI_MAP, y, w);
 
     /* Reset the line counter */
     if (y == -1) return 1;
@@ -2896,6 +3470,10 @@ int Send_term_info(struct player *p, int mode, u16b arg)
     if (mode == NTERM_ACTIVATE)
     {
         if (p->remote_term == (byte)arg) return 1;
+
+        /* Send the changes of the map before leaving it */
+        Send_dirty_chars(p);
+
         p->remote_term = (byte)arg;
     }
 
@@ -3250,6 +3828,9 @@ int Send_flush(struct player *p, bool fresh, bool delay)
     connection_t *connp = get_connp(p, "flush");
     if (connp == NULL) return 0;
 
+    /* Send the changes of the map first */
+    Send_dirty_chars(p);
+
     return Packet_printf(&connp->c, "%b%c%c", (unsigned)PKT_FLUSH, (int)fresh, (int)delay);
 }
 
@@ -3281,7 +3862,7 @@ int cmd_run(struct player *p, int dir)
     connection_t *connp = get_connp(p, "run");
     if (connp == NULL) return 0;
 
-    return Packet_printf(&connp->q, "%b%c", (unsigned)PKT_RUN, (int)dir);
+    return Packet_put_dir(&connp->q, PKT_RUN, dir);
 }
 
 
@@ -3557,7 +4138,7 @@ static int Receive_breath(int ind)
     int n;
     byte ch;
 
-    if ((n = Packet_scanf(&connp->r, "%b%c", &ch, &dir)) <= 0)
+    if ((n = Packet_get_dir(&connp->r, &ch, &dir)) <= 0)
     {
         if (n == -1) Destroy_connection(ind, "Receive_breath read error");
         return n;
@@ -3576,7 +4157,7 @@ static int Receive_breath(int ind)
             return 2;
         }
 
-        Packet_printf(&connp->q, "%b%c", (unsigned)ch, (int)dir);
+        Packet_put_dir(&connp->q, ch, dir);
         return 0;
     }
 
@@ -3592,7 +4173,7 @@ static int Receive_walk(int ind)
     char dir;
     int n;
 
-    if ((n = Packet_scanf(&connp->r, "%b%c", &ch, &dir)) <= 0)
+    if ((n = Packet_get_dir(&connp->r, &ch, &dir)) <= 0)
     {
         if (n == -1) Destroy_connection(ind, "Receive_walk read error");
         return n;
@@ -3623,7 +4204,7 @@ static int Receive_walk(int ind)
          */
         if (!connp->q.len)
         {
-            Packet_printf(&connp->q, "%b%c", (unsigned)ch, (int)dir);
+            Packet_put_dir(&connp->q, ch, dir);
             return 0;
         }
 
@@ -3634,7 +4215,7 @@ static int Receive_walk(int ind)
         if (connp->q.buf[connp->q.len - 2] == ch)
         {
             connp->q.len -= 2;
-            Packet_printf(&connp->q, "%b%c", (unsigned)ch, (int)dir);
+            Packet_put_dir(&connp->q, ch, dir);
             return 0;
         }
     }
@@ -3651,7 +4232,7 @@ static int Receive_run(int ind)
     char dir;
     int n;
 
-    if ((n = Packet_scanf(&connp->r, "%b%c", &ch, &dir)) <= 0)
+    if ((n = Packet_get_dir(&connp->r, &ch, &dir)) <= 0)
     {
         if (n == -1) Destroy_connection(ind, "Receive_run read error");
         return n;
@@ -3676,7 +4257,7 @@ static int Receive_run(int ind)
          */
         if (!connp->q.len)
         {
-            Packet_printf(&connp->q, "%b%c", (unsigned)ch, (int)dir);
+            Packet_put_dir(&connp->q, ch, dir);
             return 0;
         }
 
@@ -3687,7 +4268,7 @@ static int Receive_run(int ind)
         if (connp->q.buf[connp->q.len - 2] == ch)
         {
             connp->q.len -= 2;
-            Packet_printf(&connp->q, "%b%c", (unsigned)ch, (int)dir);
+            Packet_put_dir(&connp->q, ch, dir);
             return 0;
         }
     }
@@ -4063,7 +4644,7 @@ static int Receive_open(int ind)
     int n;
     byte ch;
 
-    if ((n = Packet_scanf(&connp->r, "%b%c", &ch, &dir)) <= 0)
+    if ((n = Packet_get_dir(&connp->r, &ch, &dir)) <= 0)
     {
         if (n == -1) Destroy_connection(ind, "Receive_open read error");
         return n;
@@ -4082,7 +4663,7 @@ static int Receive_open(int ind)
             return 2;
         }
 
-        Packet_printf(&connp->q, "%b%c", (unsigned)ch, (int)dir);
+        Packet_put_dir(&connp->q, ch, dir);
         return 0;
     }
 
@@ -4467,7 +5048,7 @@ static int Receive_disarm(int ind)
     int n;
     byte ch;
 
-    if ((n = Packet_scanf(&connp->r, "%b%c", &ch, &dir)) <= 0)
+    if ((n = Packet_get_dir(&connp->r, &ch, &dir)) <= 0)
     {
         if (n == -1) Destroy_connection(ind, "Receive_disarm read error");
         return n;
@@ -4486,7 +5067,7 @@ static int Receive_disarm(int ind)
             return 2;
         }
 
-        Packet_printf(&connp->q, "%b%c", (unsigned)ch, (int)dir);
+        Packet_put_dir(&connp->q, ch, dir);
         return 0;
     }
 
@@ -4572,7 +5153,7 @@ static int Receive_locate(int ind)
     int n;
     byte ch;
 
-    if ((n = Packet_scanf(&connp->r, "%b%c", &ch, &dir)) <= 0)
+    if ((n = Packet_get_dir(&connp->r, &ch, &dir)) <= 0)
     {
         if (n == -1) Destroy_connection(ind, "Receive_locate read error");
         return n;
@@ -4683,7 +5264,7 @@ static int Receive_close(int ind)
     int n;
     byte ch;
 
-    if ((n = Packet_scanf(&connp->r, "%b%c", &ch, &dir)) <= 0)
+    if ((n = Packet_get_dir(&connp->r, &ch, &dir)) <= 0)
     {
         if (n == -1) Destroy_connection(ind, "Receive_close read error");
         return n;
@@ -4702,7 +5283,7 @@ static int Receive_close(int ind)
             return 2;
         }
 
-        Packet_printf(&connp->q, "%b%c", (unsigned)ch, (int)dir);
+        Packet_put_dir(&connp->q, ch, dir);
         return 0;
     }
 
@@ -4991,7 +5572,7 @@ static int Receive_steal(int ind)
     int n;
     byte ch;
 
-    if ((n = Packet_scanf(&connp->r, "%b%c", &ch, &dir)) <= 0)
+    if ((n = Packet_get_dir(&connp->r, &ch, &dir)) <= 0)
     {
         if (n == -1) Destroy_connection(ind, "Receive_steal read error");
         return n;
@@ -5012,7 +5593,7 @@ static int Receive_steal(int ind)
                 return 2;
             }
 
-            Packet_printf(&connp->q, "%b%c", (unsigned)ch, (int)dir);
+            Packet_put_dir(&connp->q, ch, dir);
             return 0;
         }
         else
@@ -5184,7 +5765,7 @@ static int Receive_alter(int ind)
     int n;
     byte ch;
 
-    if ((n = Packet_scanf(&connp->r, "%b%c", &ch, &dir)) <= 0)
+    if ((n = Packet_get_dir(&connp->r, &ch, &dir)) <= 0)
     {
         if (n == -1) Destroy_connection(ind, "Receive_alter read error");
         return n;
@@ -5203,7 +5784,7 @@ static int Receive_alter(int ind)
             return 2;
         }
 
-        Packet_printf(&connp->q, "%b%c", (unsigned)ch, (int)dir);
+        Packet_put_dir(&connp->q, ch, dir);
         return 0;
     }
 
@@ -5258,7 +5839,7 @@ static int Receive_jump(int ind)
     char dir;
     int n;
 
-    if ((n = Packet_scanf(&connp->r, "%b%c", &ch, &dir)) <= 0)
+    if ((n = Packet_get_dir(&connp->r, &ch, &dir)) <= 0)
     {
         if (n == -1) Destroy_connection(ind, "Receive_jump read error");
         return n;
@@ -5284,7 +5865,7 @@ static int Receive_jump(int ind)
             return 2;
         }
 
-        Packet_printf(&connp->q, "%b%c", (unsigned)ch, (int)dir);
+        Packet_put_dir(&connp->q, ch, dir);
         return 0;
     }
 
@@ -5942,6 +6523,7 @@ static int Enter_player(int ind)
     verify_panel(p);
 
     NumPlayers++;
+    cave_players_changed();
 
     connp->id = NumConnections;
     set_player_index(connp, NumPlayers);
@@ -6053,30 +6635,109 @@ static int Enter_player(int ind)
 }
 
 
+/*
+ * Create a connection without socket for a scripted player and make it enter the game.
+ * This is only used by the benchmark mode.
+ *
+ * Return the connection index, or -1 on failure.
+ */
+int Setup_bot_connection(const char *nick, byte ridx, byte cidx, byte psex)
+{
+    int i, ind = -1;
+    connection_t *connp;
+
+    for (i = 0; (i < MAX_PLAYERS) && (conn_active_num < MAX_PLAYERS); i++)
+    {
+        if (get_connection(i)->state == CONN_FREE)
+        {
+            ind = i;
+            break;
+        }
+    }
+    if (ind == -1) return -1;
+    connp = get_connection(ind);
+
+    Sockbuf_init(&connp->w, -1, SERVER_SEND_SIZE + FRAME_OVERHEAD, SOCKBUF_WRITE);
+    Sockbuf_init(&connp->r, -1, SERVER_RECV_SIZE, SOCKBUF_WRITE | SOCKBUF_READ);
+    Sockbuf_init(&connp->c, -1, SERVER_SEND_SIZE, SOCKBUF_WRITE | SOCKBUF_READ | SOCKBUF_LOCK);
+    Sockbuf_init(&connp->q, -1, SERVER_RECV_SIZE, SOCKBUF_WRITE | SOCKBUF_READ | SOCKBUF_LOCK);
+
+    connp->id = -1;
+    connp->conntype = CONNTYPE_PLAYER;
+    connp->addr = string_make("127.0.0.1");
+    connp->real = string_make(nick);
+    connp->nick = string_make(nick);
+    connp->host = string_make("localhost");
+    connp->pass = string_make("bench");
+    connp->version = current_version();
+    connp->char_state = 1;
+    connp->ridx = ridx;
+    connp->cidx = cidx;
+    connp->psex = psex;
+
+    /* Measure the compression */
+    if (cfg_compress_level > 0) connp->deflate = net_deflate_new(cfg_compress_level);
+
+    /* Random roller */
+    for (i = 0; i < STAT_MAX; i++) connp->stat_roll[i] = 0;
+    connp->stat_roll[STAT_MAX] = BR_POINTBASED;
+
+    /* Default options */
+    for (i = 0; i < OPT_MAX; i++) connp->options[i] = option_normal(i);
+
+    /* Standard 80x24 text client */
+    alloc_client_setup(connp);
+    connp->Client_setup.settings[SETTING_SCREEN_COLS] = NORMAL_WID;
+    connp->Client_setup.settings[SETTING_SCREEN_ROWS] = NORMAL_HGT;
+    connp->Client_setup.settings[SETTING_TILE_WID] = 1;
+    connp->Client_setup.settings[SETTING_TILE_HGT] = 1;
+    connp->Client_setup.settings[SETTING_MAX_HGT] = NORMAL_HGT;
+
+    if ((connp->w.buf == NULL) || (connp->r.buf == NULL) || (connp->c.buf == NULL) ||
+        (connp->q.buf == NULL) || (connp->addr == NULL) || (connp->real == NULL) ||
+        (connp->nick == NULL) || (connp->host == NULL) || (connp->pass == NULL))
+    {
+        plog("Not enough memory for connection");
+        Destroy_connection(ind, "No memory");
+        return -1;
+    }
+
+    Conn_set_state(connp, CONN_SETUP, SETUP_TIMEOUT);
+
+    /* Create the character */
+    if (Enter_player(ind) < 0)
+    {
+        if (connp->state != CONN_FREE) Destroy_connection(ind, "Unable to play");
+        return -1;
+    }
+
+    return ind;
+}
+
+
 static bool Limit_connections(int ind)
 {
     connection_t *connp = get_connection(ind);
     int i;
 
     /* Check all connections */
-    for (i = 0; i < MAX_PLAYERS; i++)
+    for (i = 0; i < conn_active_num; i++)
     {
         connection_t *current;
 
         /* Skip current connection */
-        if (i == ind) continue;
+        if (conn_active[i] == ind) continue;
 
         /* Get connection */
-        current = get_connection(i);
+        current = get_connection(conn_active[i]);
 
         /* Skip invalid connections */
-        if (current->state == CONN_FREE) continue;
         if (current->state == CONN_CONSOLE) continue;
 
         /* Check name */
         if (my_stricmp(current->nick, connp->nick) == 0)
         {
-            Destroy_connection(i, "Resume connection");
+            Destroy_connection(conn_active[i], "Resume connection");
             return false;
         }
     }
@@ -7352,14 +8013,14 @@ bool process_pending_commands(int ind)
                 Destroy_connection(ind, "Can't copy read data to queue buffer");
                 return true;
             }
-            last_pos = (int)connp->r.ptr;
+            last_pos = (int)(connp->r.ptr - connp->r.buf);
             type = (connp->r.ptr[0] & 0xFF);
 
             /* Paranoia */
             if ((type < PKT_UNDEFINED) || (type >= PKT_MAX)) type = PKT_UNDEFINED;
             
             result = (*receive_tbl[type])(ind);
-            data_advance += ((int)connp->r.ptr - last_pos);
+            data_advance += ((int)(connp->r.ptr - connp->r.buf) - last_pos);
             ht_copy(&connp->start, &turn);
             if (result == 0) return true;
             Sockbuf_clear(&connp->q);
@@ -7450,32 +8111,29 @@ int Net_input(void)
     connection_t *connp;
     char msg[MSG_LEN];
 
-    for (i = 0; i < MAX_PLAYERS; i++)
+    /* Handle the timeouts */
+    while (conn_heap_num)
     {
+        i = conn_heap[0];
         connp = get_connection(i);
 
-        if (connp->state == CONN_FREE) continue;
-        if (connp->state == CONN_CONSOLE) continue;
+        /* Nothing expiring yet */
+        if (ht_cmp(&turn, &connp->deadline) < 0) break;
 
-        /* Handle the timeout */
-        if (ht_diff(&turn, &connp->start) > (u32b)(connp->timeout * cfg_fps))
+        /* The connection has been active since: push its deadline back */
+        if (ht_diff(&turn, &connp->start) <= (u32b)(connp->timeout * cfg_fps))
         {
-            if (connp->state == CONN_QUIT)
-                Destroy_connection(i, connp->quit_msg);
-            else
-            {
-                strnfmt(msg, sizeof(msg), "Timeout %02x", connp->state);
-                Destroy_connection(i, msg);
-            }
+            conn_heap_update(connp);
             continue;
         }
 
-        /*
-         * Make sure that the player we are looking at is not already in the
-         * game. If he is already in the game then we will send him data
-         * in the function Net_output.
-         */
-        if (connp->id != -1) continue;
+        if (connp->state == CONN_QUIT)
+            Destroy_connection(i, connp->quit_msg);
+        else
+        {
+            strnfmt(msg, sizeof(msg), "Timeout %02x", connp->state);
+            Destroy_connection(i, msg);
+        }
     }
 
     if (num_logins | num_logouts)
@@ -7512,13 +8170,19 @@ int Net_output_p(struct player *p)
 {
     connection_t *connp = get_connection(p->conn);
 
+    /*
+     * Send the changes of the map, unless the client is lagging behind: in that case they
+     * pile up and are sent later as fewer and larger runs
+     */
+    if (!Conn_is_congested(p->conn)) Send_dirty_chars(p);
+
     /*
      * If we have any data to send to the client, terminate it
      * and send it to the client.
      */
     if (connp->c.len > 0)
     {
-        if (Packet_printf(&connp->c, "%b", (unsigned)PKT_END) <= 0)
+        if (Packet_put_type(&connp->c, PKT_END) <= 0)
         {
             Destroy_connection(p->conn, "Net output write error");
             return 1;
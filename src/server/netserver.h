@@ -6,6 +6,8 @@
 #ifndef __Netserver_h
 #define __Netserver_h
 
+struct birth_options;
+
 #define FREE_TIMEOUT    15
 #define SETUP_TIMEOUT   180
 #define PLAY_TIMEOUT    30
@@ -24,6 +26,13 @@
 #define ACTION_PICKUP   1
 #define ACTION_GO_DOWN  2
 
+/*
+ * Console settings
+ */
+#define CONSOLE_LISTEN  0
+#define CONSOLE_AUTH    1
+#define CONSOLE_PROFILE 2
+
 /* Mental links */
 #define LINK_NONE       0
 #define LINK_DOMINANT   1
@@ -56,15 +65,27 @@ typedef struct
     bool            options[OPT_MAX];
     bool            console_authenticated;
     bool            console_listen;
+    bool            console_profile;
     byte            console_channels[MAX_CHANNELS];
     u32b            account;
     char            *quit_msg;
+    struct net_deflate *deflate;    /* Compression of the stream (if asked by the client) */
+    u64b            bytes_raw;      /* Data sent (before compression) */
+    u64b            bytes_sent;     /* Data sent (after compression) */
+    u64b            deflate_time;   /* Time spent compressing (ns) */
+    struct out_queue oq;            /* Data waiting for the socket */
+    bool            oq_watch;       /* Waiting for the socket to become writable */
+    int             active_pos;     /* Position in the list of connections in use (+1) */
+    int             heap_pos;       /* Position in the heap of deadlines (+1) */
+    hturn           deadline;       /* Turn at which the connection would time out */
 } connection_t;
 
 /*** Player connection/index wrappers ***/
 extern connection_t *get_connection(long idx);
 extern long get_player_index(connection_t *connp);
 extern void set_player_index(connection_t *connp, long idx);
+extern int Conn_active_num(void);
+extern int Conn_active(int i);
 
 /*** General utilities ***/
 extern int Setup_net_server(void);
@@ -79,6 +100,10 @@ extern void Conn_set_console_setting(int ind, int set, bool val);
 extern bool Conn_get_console_setting(int ind, int set);
 extern int Init_setup(void);
 extern byte *Conn_get_console_channels(int ind);
+extern int Setup_bot_connection(const char *nick, byte ridx, byte cidx, byte psex);
+extern void Conn_describe_traffic(int ind, char *buf, size_t len);
+extern void Net_describe_traffic(char *buf, size_t len);
+extern bool Conn_is_congested(int ind);
 
 /*** Sending ***/
 extern int Send_basic_info(int ind);
@@ -128,6 +153,8 @@ extern int Send_study(struct player *p, int study, bool can_study_book);
 extern int Send_count(struct player *p, byte type, s16b count);
 extern int Send_show_floor(struct player *p, byte mode);
 extern int Send_char(struct player *p, struct loc *grid, u16b a, char c, u16b ta, char tc);
+extern void Send_char_later(struct player *p, struct loc *grid);
+extern void Send_dirty_chars(struct player *p);
 extern int Send_spell_info(struct player *p, int book, int i, const char *out_val,
     spell_flags *flags);
 extern int Send_book_info(struct player *p, int book, const char *name);
@@ -190,10 +217,14 @@ extern int Net_output_p(struct player *p);
 extern bool process_turn_based(void);
 
 /* account.c */
+extern void accounts_free(void);
+extern bool accounts_load(const char *filename);
+extern bool accounts_init(void);
 extern u32b get_account(const char *name, const char *pass);
 
 /* control.c */
 extern void console_print(char *msg, int chan);
+extern void console_profile_summary(void);
 extern void NewConsole(int fd, int arg);
 
 #endif
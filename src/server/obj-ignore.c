@@ -418,6 +418,7 @@ int remove_autoinscription(struct player *p, s16b kind)
     if (!k) return 0;
     if (!p->note_aware[kind]) return 0;
 
+    quark_release(p->note_aware[kind]);
     p->note_aware[kind] = 0;
     return 1;
 }
@@ -429,9 +430,12 @@ int remove_autoinscription(struct player *p, s16b kind)
 int add_autoinscription(struct player *p, s16b kind, const char *inscription)
 {
     struct object_kind *k = &k_info[kind];
+    quark_t note;
 
     if (!k) return 0;
     if (!inscription || STRZERO(inscription)) return remove_autoinscription(p, kind);
-    p->note_aware[kind] = quark_add(inscription);
+    note = quark_add_ref(inscription);
+    quark_release(p->note_aware[kind]);
+    p->note_aware[kind] = note;
     return 1;
 }
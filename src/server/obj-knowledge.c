@@ -867,6 +867,7 @@ void object_sense(struct player *p, struct object *obj)
     loc_copy(&new_obj->grid, &obj->grid);
     memcpy(&new_obj->wpos, &obj->wpos, sizeof(struct worldpos));
     pile_insert_end(&square_p(p, &new_obj->grid)->obj, new_obj);
+    square_track_pile(p, &new_obj->grid);
 }
 
 
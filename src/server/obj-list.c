@@ -139,89 +139,118 @@ static bool object_list_should_ignore_object(struct player *p, struct chunk *c,
 
 
 /*
- * Collect object information from the current cave.
+ * Collect the objects of a pile.
+ *
+ * Objects only stack in the list when they are on the same grid (see object_stackable()),
+ * so an object is only matched against the entries added for the same pile.
  */
-void object_list_collect(struct player *p, object_list_t *list)
+static bool object_list_collect_pile(struct player *p, struct chunk *c, object_list_t *list,
+    struct loc *grid)
 {
-	int i;
-    struct chunk *c = chunk_get(&p->wpos);
-    struct loc begin, end;
-    struct loc_iterator iter;
+    struct object *obj = square_known_pile(p, c, grid);
+    size_t first = list->distinct_entries;
+    int field;
+    bool los;
 
-	if (!object_list_can_update(list)) return;
+    /* Skip unfilled entries, unknown objects and monster-held objects */
+    if (!obj) return true;
 
-    loc_init(&begin, 1, 1);
-    loc_init(&end, c->width, c->height);
-    loc_iterator_first(&iter, &begin, &end);
+    /* Determine which section of the list the object entry is in (no need to trace a path
+     * to a pile out of range) */
+    if (loc_eq(grid, &p->grid)) los = true;
+    else if (MAX(ABS(grid->y - p->grid.y), ABS(grid->x - p->grid.x)) > z_info->max_range)
+        los = false;
+    else
+        los = projectable(c, &p->grid, grid, PROJECT_NONE, true);
+    field = (los? OBJECT_LIST_SECTION_LOS: OBJECT_LIST_SECTION_NO_LOS);
 
-	/* Scan each object in the dungeon. */
-    do
+    for ( ; obj; obj = obj->next)
     {
-        object_list_entry_t *entry;
-        int entry_index;
-        int field;
-        bool los = false;
-        struct object *obj;
+        object_list_entry_t *entry = NULL;
+        size_t entry_index;
 
-        obj = square_known_pile(p, c, &iter.cur);
+        if (object_list_should_ignore_object(p, c, obj)) continue;
 
-        /* Skip unfilled entries, unknown objects and monster-held objects */
-        if (!obj) continue;
-
-        /* Determine which section of the list the object entry is in */
-        los = (projectable(c, &p->grid, &iter.cur, PROJECT_NONE, true) ||
-            loc_eq(&iter.cur, &p->grid));
-        field = (los? OBJECT_LIST_SECTION_LOS: OBJECT_LIST_SECTION_NO_LOS);
-
-        for ( ; obj; obj = obj->next)
+        /* Use a matching object if we find one. */
+        if (!is_unknown(obj))
         {
-            if (object_list_should_ignore_object(p, c, obj)) continue;
-
-            /* Find or add a list entry. */
-            entry = NULL;
-            for (entry_index = 0; entry_index < (int)list->entries_size; entry_index++)
+            for (entry_index = first; entry_index < list->distinct_entries; entry_index++)
             {
-                int j;
-
-                /* We found an empty slot, so add this object here. */
-                if (list->entries[entry_index].object == NULL)
-                {
-                    list->entries[entry_index].object = obj;
-                    for (j = 0; j < OBJECT_LIST_SECTION_MAX; j++)
-                        list->entries[entry_index].count[j] = 0;
-                    list->entries[entry_index].dy = iter.cur.y - p->grid.y;
-                    list->entries[entry_index].dx = iter.cur.x - p->grid.x;
-                    list->entries[entry_index].player = p;
-                    entry = &list->entries[entry_index];
-                    break;
-                }
-
-                /* Use a matching object if we find one. */
-                if (!is_unknown(obj) &&
-                    object_similar(p, obj, list->entries[entry_index].object, OSTACK_LIST))
+                if (object_similar(p, obj, list->entries[entry_index].object, OSTACK_LIST))
                 {
                     /* We found a matching object and we'll use that. */
                     entry = &list->entries[entry_index];
                     break;
                 }
             }
+        }
+
+        /* Add a list entry. */
+        if (entry == NULL)
+        {
+            if (list->distinct_entries >= list->entries_size) return false;
+
+            entry = &list->entries[list->distinct_entries++];
+            entry->object = obj;
+            memset(entry->count, 0, sizeof(entry->count));
+            entry->dy = grid->y - p->grid.y;
+            entry->dx = grid->x - p->grid.x;
+            entry->player = p;
+        }
+
+        /* We only know the number of objects we've actually seen */
+        if (!is_unknown(obj))
+            entry->count[field] += obj->number;
+        else
+            entry->count[field] = 1;
+    }
 
-            if (entry == NULL) return;
+    return true;
+}
+
+
+/*
+ * Collect object information from the current cave.
+ *
+ * Only the grids where the player knows a pile are visited, in grid order.
+ */
+void object_list_collect(struct player *p, object_list_t *list)
+{
+	int i;
+    struct chunk *c = chunk_get(&p->wpos);
 
-            /* We only know the number of objects we've actually seen */
-            if (!is_unknown(obj))
-                entry->count[field] += obj->number;
-            else
-                entry->count[field] = 1;
+	if (!object_list_can_update(list)) return;
+
+    /* Hack -- DM has full knowledge: scan the whole level */
+    if (p->dm_flags & DM_SEE_LEVEL)
+    {
+        struct loc begin, end;
+        struct loc_iterator iter;
+
+        loc_init(&begin, 1, 1);
+        loc_init(&end, c->width, c->height);
+        loc_iterator_first(&iter, &begin, &end);
+
+        do
+        {
+            if (!object_list_collect_pile(p, c, list, &iter.cur)) return;
+        }
+        while (loc_iterator_next_strict(&iter));
+    }
+    else
+    {
+        square_sort_piles(p);
+        for (i = 0; i < p->cave->piles_num; i++)
+        {
+            if (!object_list_collect_pile(p, c, list, &p->cave->piles[i])) return;
         }
     }
-    while (loc_iterator_next_strict(&iter));
 
 	/* Collect totals for easier calculations of the list. */
-	for (i = 0; i < (int)list->entries_size; i++)
+    memset(list->total_entries, 0, sizeof(list->total_entries));
+    memset(list->total_objects, 0, sizeof(list->total_objects));
+	for (i = 0; i < (int)list->distinct_entries; i++)
     {
-		if (list->entries[i].object == NULL) continue;
-
 		if (list->entries[i].count[OBJECT_LIST_SECTION_LOS] > 0)
 			list->total_entries[OBJECT_LIST_SECTION_LOS]++;
 
@@ -232,7 +261,6 @@ void object_list_collect(struct player *p, object_list_t *list)
             list->entries[i].count[OBJECT_LIST_SECTION_LOS];
 		list->total_objects[OBJECT_LIST_SECTION_NO_LOS] +=
             list->entries[i].count[OBJECT_LIST_SECTION_NO_LOS];
-		list->distinct_entries++;
 	}
 
 	list->sorted = false;
@@ -1068,7 +1068,7 @@ bool create_randart_drop(struct player *p, struct chunk *c, struct object **obj_
     /* We must pass depth and rarity checks */
     if (check && !artifact_pass_checks(art, c->wpos.depth))
     {
-        free_artifact(art);
+        release_randart(art);
         return false;
     }
 
@@ -1083,7 +1083,7 @@ bool create_randart_drop(struct player *p, struct chunk *c, struct object **obj_
     make_randart(p, c, *obj_address, art, randart_seed);
 
     /* Success */
-    free_artifact(art);
+    release_randart(art);
     return true;
 }
 
@@ -2057,7 +2057,7 @@ void reroll_randart(struct player *p, struct chunk *c)
     obj->creator = p->id;
 
     /* Success */
-    free_artifact(art);
+    release_randart(art);
     msg(p, "You manage to reroll the random artifact.");
 
     if (object_has_standard_to_h(obj)) obj->known->to_h = 1;
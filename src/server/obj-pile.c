@@ -249,12 +249,139 @@ bool pile_contains(const struct object *top, const struct object *obj)
 }
 
 
+/*
+ * Object pool
+ *
+ * Objects (and their known versions) are created and freed all the time by level generation,
+ * store maintenance, drops and decay. Instead of going to the heap each time, they are taken
+ * from slabs of OBJECT_SLAB_SIZE objects. Each slab keeps the list of its free slots, and the
+ * slabs with free slots are linked together, the empty ones last so that new objects fill the
+ * slabs already in use. Empty slabs are given back to the heap in bulk by object_pool_trim()
+ * when a level is freed, keeping OBJECT_SLABS_SPARE of them for the next level.
+ *
+ * When freed memory is poisoned (see mem_flags), freed objects are poisoned too, and the poison
+ * is checked when the slot is reused to catch writes to freed objects. Freeing an object twice
+ * is always caught.
+ */
+#define OBJECT_SLAB_SIZE    128
+#define OBJECT_SLABS_SPARE  8
+#define OBJECT_POISON       0xCD
+
+struct object_slab;
+
+struct object_slot
+{
+    struct object obj;              /* Object (first, to find the slot from the object) */
+    struct object_slab *slab;       /* Slab holding the slot */
+    struct object_slot *next_free;  /* Next free slot of the slab */
+    bool used;                      /* Slot holds an object */
+};
+
+struct object_slab
+{
+    struct object_slot slots[OBJECT_SLAB_SIZE];
+    struct object_slot *free;       /* Free slots */
+    int used;                       /* Number of objects */
+    struct object_slab *prev;       /* Slabs with free slots */
+    struct object_slab *next;
+};
+
+static struct object_slab *object_slabs, *object_slabs_last;
+static u32b object_slabs_num, object_slabs_peak;
+static u32b object_num, object_peak;
+static u32b object_allocs, object_frees;
+
+
+static void object_slab_link(struct object_slab *slab, bool last)
+{
+    if (last)
+    {
+        slab->prev = object_slabs_last;
+        slab->next = NULL;
+    }
+    else
+    {
+        slab->prev = NULL;
+        slab->next = object_slabs;
+    }
+    if (slab->prev) slab->prev->next = slab;
+    else object_slabs = slab;
+    if (slab->next) slab->next->prev = slab;
+    else object_slabs_last = slab;
+}
+
+
+static void object_slab_unlink(struct object_slab *slab)
+{
+    if (slab->prev) slab->prev->next = slab->next;
+    else object_slabs = slab->next;
+    if (slab->next) slab->next->prev = slab->prev;
+    else object_slabs_last = slab->prev;
+    slab->prev = slab->next = NULL;
+}
+
+
+static bool object_poisoned(const struct object *obj)
+{
+    const byte *mem = (const byte *)obj;
+    size_t i;
+
+    for (i = 0; i < sizeof(struct object); i++)
+    {
+        if (mem[i] != OBJECT_POISON) return false;
+    }
+
+    return true;
+}
+
+
 /*
  * Create a new object and return it
  */
 struct object *object_new(void)
 {
-    return mem_zalloc(sizeof(struct object));
+    struct object_slab *slab = object_slabs;
+    struct object_slot *slot;
+
+    /* All the slabs are full: get a new one */
+    if (!slab)
+    {
+        int i;
+
+        slab = mem_alloc(sizeof(*slab));
+        slab->free = NULL;
+        slab->used = 0;
+        for (i = OBJECT_SLAB_SIZE - 1; i >= 0; i--)
+        {
+            slab->slots[i].slab = slab;
+            slab->slots[i].next_free = slab->free;
+            slab->slots[i].used = false;
+            slab->free = &slab->slots[i];
+            if (mem_flags & MEM_POISON_FREE)
+                memset(&slab->slots[i].obj, OBJECT_POISON, sizeof(struct object));
+        }
+        object_slab_link(slab, false);
+        object_slabs_num++;
+        if (object_slabs_num > object_slabs_peak) object_slabs_peak = object_slabs_num;
+    }
+
+    /* Take a free slot */
+    slot = slab->free;
+    slab->free = slot->next_free;
+    slab->used++;
+    if (!slab->free) object_slab_unlink(slab);
+
+    if ((mem_flags & MEM_POISON_FREE) && !object_poisoned(&slot->obj))
+        quit_fmt("Object pool: object %p was modified after being freed", (void *)&slot->obj);
+
+    memset(&slot->obj, 0, sizeof(struct object));
+    slot->used = true;
+
+    object_allocs++;
+    object_num++;
+    if (object_num > object_peak) object_peak = object_num;
+
+    return &slot->obj;
 }
 
 
@@ -265,11 +392,80 @@ struct object *object_new(void)
  */
 void object_free(struct object *obj)
 {
+    struct object_slot *slot = (struct object_slot *)obj;
+    struct object_slab *slab = slot->slab;
+
+    if (!slot->used) quit_fmt("Object pool: object %p was freed twice", (void *)obj);
+
     mem_free(obj->slays);
     mem_free(obj->brands);
     mem_free(obj->curses);
 
-    mem_free(obj);
+    if (mem_flags & MEM_POISON_FREE) memset(obj, OBJECT_POISON, sizeof(struct object));
+    slot->used = false;
+
+    object_frees++;
+    object_num--;
+
+    /* Give the slot back to its slab */
+    if (!slab->free) object_slab_link(slab, false);
+    slot->next_free = slab->free;
+    slab->free = slot;
+    slab->used--;
+
+    /* Empty slabs go last */
+    if (!slab->used && (slab != object_slabs_last))
+    {
+        object_slab_unlink(slab);
+        object_slab_link(slab, true);
+    }
+}
+
+
+/*
+ * Give the empty slabs back to the heap, keeping "spare" of them
+ */
+static void object_pool_release(u32b spare)
+{
+    struct object_slab *slab = object_slabs_last;
+
+    while (slab && !slab->used)
+    {
+        struct object_slab *prev = slab->prev;
+
+        if (spare) spare--;
+        else
+        {
+            object_slab_unlink(slab);
+            mem_free(slab);
+            object_slabs_num--;
+        }
+        slab = prev;
+    }
+}
+
+
+void object_pool_trim(void)
+{
+    object_pool_release(OBJECT_SLABS_SPARE);
+}
+
+
+void object_pool_free(void)
+{
+    object_pool_release(0);
+}
+
+
+void object_pool_describe(char *buf, size_t len)
+{
+    u32b slots = object_slabs_num * OBJECT_SLAB_SIZE;
+
+    strnfmt(buf, len, "Object pool: %lu objects (peak %lu) in %lu slabs (peak %lu), %lu%% used, "
+        "%lu allocations, %lu frees", (unsigned long)object_num, (unsigned long)object_peak,
+        (unsigned long)object_slabs_num, (unsigned long)object_slabs_peak,
+        (unsigned long)(slots? object_num * 100 / slots: 0), (unsigned long)object_allocs,
+        (unsigned long)object_frees);
 }
 
 
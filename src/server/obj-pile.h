@@ -39,6 +39,9 @@ extern struct object *pile_last_item(struct object *pile);
 extern bool pile_contains(const struct object *top, const struct object *obj);
 extern struct object *object_new(void);
 extern void object_free(struct object *obj);
+extern void object_pool_trim(void);
+extern void object_pool_free(void);
+extern void object_pool_describe(char *buf, size_t len);
 extern void object_delete(struct object **obj_address);
 extern void object_pile_free(struct object *obj);
 extern bool object_stackable(struct player *p, const struct object *obj1,
@@ -215,6 +215,46 @@ static s16b art_idx_high_resist[] =
 static struct artifact_set_data local_data;
 
 
+/*
+ * Cache of random artifacts
+ *
+ * A random artifact is rebuilt from its seed by running the whole design process again each
+ * time it is described, made or its level is needed. The results are kept in a bounded table
+ * keyed by seed and artifact index, made of sets of RANDART_CACHE_WAYS entries where the least
+ * recently used entry is replaced. Entries are reference-counted, so that an entry replaced
+ * while in use is only freed by its last release. Names only depend on the seed and are cached
+ * the same way.
+ */
+#define RANDART_CACHE_BITS  8
+#define RANDART_CACHE_WAYS  4
+#define RANDART_CACHE_SIZE  ((1 << RANDART_CACHE_BITS) * RANDART_CACHE_WAYS)
+
+struct randart_entry
+{
+    struct artifact art;    /* Random artifact (first, to find the entry from the artifact) */
+    s32b seed;              /* Randart seed */
+    u32b aidx;              /* Index of the static artifact */
+    bool valid;             /* The random artifact could be designed */
+    bool cached;            /* The entry is still in the cache */
+    int refs;               /* Number of users */
+    u32b used;              /* Time of last use */
+};
+
+struct randart_name
+{
+    s32b seed;
+    bool valid;
+    u32b used;
+    char name[MAX_RNAME_LEN + 8];
+};
+
+static struct randart_entry *randart_cache[RANDART_CACHE_SIZE];
+static struct randart_name randart_names[RANDART_CACHE_SIZE];
+static u32b randart_cache_clock;
+static u32b randart_cache_hits, randart_cache_misses;
+static u32b randart_name_hits, randart_name_misses;
+
+
 /*
  * Wrapper functions for tvals (TODO: move this to obj-tval.c)
  */
@@ -2878,12 +2918,22 @@ static char dummy[6] = "dummy";
 
 
 /*
- * Create a random artifact
+ * Free the arrays of an artifact
  */
-static struct artifact* create_artifact(struct artifact *a, struct artifact_set_data *data)
+static void free_artifact_data(struct artifact *art)
 {
-    struct artifact *art = mem_zalloc(sizeof(*art));
+    mem_free(art->slays);
+    mem_free(art->brands);
+    mem_free(art->curses);
+}
+
 
+/*
+ * Create a random artifact
+ */
+static bool create_artifact(struct artifact *art, struct artifact *a,
+    struct artifact_set_data *data)
+{
     /* Copy info from the corresponding static artifact */
     memcpy(art, a, sizeof(*a));
 
@@ -2909,23 +2959,82 @@ static struct artifact* create_artifact(struct artifact *a, struct artifact_set_
     if (!design_artifact(art, data))
     {
         /* Failure */
-        free_artifact(art);
-        return NULL;
+        free_artifact_data(art);
+        return false;
     }
 
     /* Success */
-    return art;
+    return true;
+}
+
+
+/*
+ * First slot of the set holding a random artifact in the cache
+ */
+static u32b randart_cache_set(s32b randart_seed, u32b aidx)
+{
+    u32b h = ((u32b)randart_seed ^ (aidx * 0x9E3779B1)) * 0x9E3779B1;
+
+    return (h >> (32 - RANDART_CACHE_BITS)) * RANDART_CACHE_WAYS;
+}
+
+
+static void randart_entry_free(struct randart_entry *entry)
+{
+    if (entry->valid) free_artifact_data(&entry->art);
+    mem_free(entry);
+}
+
+
+/*
+ * Remove an entry from the cache, freeing it if nobody uses it anymore
+ */
+static void randart_cache_drop(u32b slot)
+{
+    struct randart_entry *entry = randart_cache[slot];
+
+    if (!entry) return;
+    randart_cache[slot] = NULL;
+    entry->cached = false;
+    if (!entry->refs) randart_entry_free(entry);
 }
 
 
 /*
  * Generate a random artifact
+ *
+ * The result is shared and must not be modified: release it with release_randart().
  */
 struct artifact* do_randart(s32b randart_seed, struct artifact *a)
 {
     u32b tmp_seed;
     bool rand_old;
-    struct artifact *art;
+    u32b set = randart_cache_set(randart_seed, a->aidx), slot = set, i;
+    struct randart_entry *entry;
+
+    for (i = set; i < set + RANDART_CACHE_WAYS; i++)
+    {
+        entry = randart_cache[i];
+
+        /* Already generated */
+        if (entry && (entry->seed == randart_seed) && (entry->aidx == a->aidx))
+        {
+            randart_cache_hits++;
+            entry->used = ++randart_cache_clock;
+            if (!entry->valid) return NULL;
+            entry->refs++;
+            return &entry->art;
+        }
+
+        /* Replace an empty or the least recently used entry */
+        if (!randart_cache[slot]) continue;
+        if (!entry || (entry->used < randart_cache[slot]->used)) slot = i;
+    }
+    randart_cache_misses++;
+
+    entry = mem_zalloc(sizeof(*entry));
+    entry->seed = randart_seed;
+    entry->aidx = a->aidx;
 
     /* Save the RNG */
     tmp_seed = Rand_value;
@@ -2936,14 +3045,36 @@ struct artifact* do_randart(s32b randart_seed, struct artifact *a)
     Rand_quick = true;
 
     /* Generate the random artifact */
-    art = create_artifact(a, &local_data);
+    entry->valid = create_artifact(&entry->art, a, &local_data);
 
     /* When done, resume use of the Angband "complex" RNG. */
     Rand_value = tmp_seed;
     Rand_quick = rand_old;
 
+    /* Replace the previous entry */
+    randart_cache_drop(slot);
+    randart_cache[slot] = entry;
+    entry->cached = true;
+    entry->used = ++randart_cache_clock;
+
     /* Return the random artifact */
-    return art;
+    if (!entry->valid) return NULL;
+    entry->refs++;
+    return &entry->art;
+}
+
+
+/*
+ * Release a random artifact obtained from do_randart()
+ */
+void release_randart(struct artifact *art)
+{
+    struct randart_entry *entry = (struct randart_entry *)art;
+
+    if (!art) return;
+
+    entry->refs--;
+    if (!entry->refs && !entry->cached) randart_entry_free(entry);
 }
 
 
@@ -2954,6 +3085,26 @@ void do_randart_name(s32b randart_seed, char *buffer, int len)
 {
     u32b tmp_seed;
     bool rand_old;
+    u32b set = randart_cache_set(randart_seed, 0), i;
+    struct randart_name *cached = &randart_names[set];
+
+    for (i = set; i < set + RANDART_CACHE_WAYS; i++)
+    {
+        /* Already generated */
+        if (randart_names[i].valid && (randart_names[i].seed == randart_seed))
+        {
+            randart_name_hits++;
+            randart_names[i].used = ++randart_cache_clock;
+            my_strcpy(buffer, randart_names[i].name, len);
+            return;
+        }
+
+        /* Replace an empty or the least recently used name */
+        if (!cached->valid) continue;
+        if (!randart_names[i].valid || (randart_names[i].used < cached->used))
+            cached = &randart_names[i];
+    }
+    randart_name_misses++;
 
     /* Save the RNG */
     tmp_seed = Rand_value;
@@ -2964,11 +3115,44 @@ void do_randart_name(s32b randart_seed, char *buffer, int len)
     Rand_quick = true;
 
     /* Generate a random name */
-    artifact_gen_name(buffer, len, name_sections);
+    artifact_gen_name(cached->name, sizeof(cached->name), name_sections);
 
     /* When done, resume use of the Angband "complex" RNG. */
     Rand_value = tmp_seed;
     Rand_quick = rand_old;
+
+    cached->seed = randart_seed;
+    cached->valid = true;
+    cached->used = ++randart_cache_clock;
+    my_strcpy(buffer, cached->name, len);
+}
+
+
+/*
+ * Forget all the random artifacts generated so far
+ */
+void randart_cache_flush(void)
+{
+    u32b slot;
+
+    for (slot = 0; slot < RANDART_CACHE_SIZE; slot++) randart_cache_drop(slot);
+    memset(randart_names, 0, sizeof(randart_names));
+}
+
+
+void randart_cache_describe(char *buf, size_t len)
+{
+    u32b slot;
+    int num = 0;
+
+    for (slot = 0; slot < RANDART_CACHE_SIZE; slot++)
+    {
+        if (randart_cache[slot]) num++;
+    }
+
+    strnfmt(buf, len, "Randart cache: %d randarts, %lu hits, %lu misses, names %lu hits, %lu misses",
+        num, (unsigned long)randart_cache_hits, (unsigned long)randart_cache_misses,
+        (unsigned long)randart_name_hits, (unsigned long)randart_name_misses);
 }
 
 
@@ -2977,6 +3161,9 @@ void do_randart_name(s32b randart_seed, char *buffer, int len)
  */
 void init_randart_generator(void)
 {
+    /* The previous random artifacts were made from the old data */
+    randart_cache_flush();
+
     memset(&local_data, 0, sizeof(local_data));
 
     /*
@@ -3009,7 +3196,7 @@ int get_artifact_level(const struct object *obj)
     lev = art->level;
 
     if (obj->randart_seed)
-        free_artifact(art);
+        release_randart(art);
 
     return lev;
 }
@@ -3017,8 +3204,6 @@ int get_artifact_level(const struct object *obj)
 
 void free_artifact(struct artifact *art)
 {
-    mem_free(art->slays);
-    mem_free(art->brands);
-    mem_free(art->curses);
+    free_artifact_data(art);
     mem_free(art);
 }
@@ -77,7 +77,10 @@ struct artifact_set_data
 
 extern int get_new_esp(bitflag flags[OF_SIZE]);
 extern struct artifact* do_randart(s32b randart_seed, struct artifact *art);
+extern void release_randart(struct artifact *art);
 extern void do_randart_name(s32b randart_seed, char *buffer, int len);
+extern void randart_cache_flush(void);
+extern void randart_cache_describe(char *buf, size_t len);
 extern void init_randart_generator(void);
 extern int get_artifact_level(const struct object *obj);
 extern void free_artifact(struct artifact *art);
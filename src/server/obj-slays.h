@@ -6,6 +6,8 @@
 #ifndef OBJECT_SLAYS_H
 #define OBJECT_SLAYS_H
 
+struct side_effects;
+
 extern struct slay *slays;
 extern struct brand *brands;
 
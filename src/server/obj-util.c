@@ -1033,9 +1033,9 @@ void object_own(struct player *p, struct object *obj)
     /* Set level requirement on free objects */
     if (!obj->owner)
     {
-        int depth = max(min(p->wpos.depth / 2, 50), 1);
+        int depth = MAX(MIN(p->wpos.depth / 2, 50), 1);
 
-        obj->level_req = min(depth, p->lev);
+        obj->level_req = MIN(depth, p->lev);
     }
 
     /* Set ownership */
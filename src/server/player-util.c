@@ -97,6 +97,9 @@ void dungeon_change_level(struct player *p, struct chunk *c, struct worldpos *ne
     /* One less player here */
     leave_depth(p, c);
 
+    /* Players only see each other on the same level */
+    forget_player(p);
+
     /* Adjust player energy */
     set_energy(p, new_wpos);
 
@@ -108,6 +111,8 @@ void dungeon_change_level(struct player *p, struct chunk *c, struct worldpos *ne
 
     /* Generate a new level (later) */
     p->upkeep->new_level_method = new_level_method;
+    p->upkeep->limbo = true;
+    cave_players_changed();
     p->upkeep->redraw |= (PR_DTRAP);
 
     /* Hack -- deactivate recall for force_descend players */
@@ -1803,12 +1808,67 @@ bool forbid_entrance_strong(struct player *p)
 }
 
 
+/*
+ * Get what a player knows about another player
+ *
+ * Only the players that have been seen or detected since entering the level have an
+ * entry, so this list stays as small as the number of players on the level. If "add"
+ * is true, a blank entry is created when there is none, otherwise NULL is returned.
+ */
+struct player_vis *player_vis_get(struct player *p, struct player *q, bool add)
+{
+    int i;
+
+    for (i = 0; i < p->play_vis_num; i++)
+    {
+        if (p->play_vis[i].id == q->id) return &p->play_vis[i];
+    }
+
+    if (!add) return NULL;
+
+    /* Make room */
+    if (p->play_vis_num == p->play_vis_max)
+    {
+        p->play_vis_max = (p->play_vis_max? p->play_vis_max * 2: 4);
+        p->play_vis = mem_realloc(p->play_vis, p->play_vis_max * sizeof(struct player_vis));
+    }
+
+    /* Add a blank entry */
+    memset(&p->play_vis[p->play_vis_num], 0, sizeof(struct player_vis));
+    p->play_vis[p->play_vis_num].id = q->id;
+
+    return &p->play_vis[p->play_vis_num++];
+}
+
+
+/*
+ * Forget what a player knows about another player
+ */
+void player_vis_forget(struct player *p, struct player *q)
+{
+    struct player_vis *v = player_vis_get(p, q, false);
+
+    if (!v) return;
+
+    /* Move the last entry to the free slot */
+    p->play_vis_num--;
+    if (v != &p->play_vis[p->play_vis_num])
+        memcpy(v, &p->play_vis[p->play_vis_num], sizeof(struct player_vis));
+}
+
+
 /*
  * Player is in the player's field of view
  */
 bool player_is_in_view(struct player *p, int p_idx)
 {
-    return mflag_has(p->pflag[p_idx], MFLAG_VIEW);
+    struct player *q = player_get(p_idx);
+    struct player_vis *v;
+
+    if (!q) return false;
+    v = player_vis_get(p, q, false);
+
+    return (v && mflag_has(v->mflag, MFLAG_VIEW));
 }
 
 
@@ -1817,7 +1877,13 @@ bool player_is_in_view(struct player *p, int p_idx)
  */
 bool player_is_visible(struct player *p, int p_idx)
 {
-    return mflag_has(p->pflag[p_idx], MFLAG_VISIBLE);
+    struct player *q = player_get(p_idx);
+    struct player_vis *v;
+
+    if (!q) return false;
+    v = player_vis_get(p, q, false);
+
+    return (v && mflag_has(v->mflag, MFLAG_VISIBLE));
 }
 
 
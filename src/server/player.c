@@ -276,7 +276,7 @@ void player_flags(struct player *p, bitflag f[OF_SIZE])
     int i;
 
     /* Unencumbered monks get nice abilities */
-    bool restrict = (player_has(p, PF_MARTIAL_ARTS) && !monk_armor_ok(p));
+    bool restricted = (player_has(p, PF_MARTIAL_ARTS) && !monk_armor_ok(p));
 
     /* Clear */
     of_wipe(f);
@@ -285,7 +285,7 @@ void player_flags(struct player *p, bitflag f[OF_SIZE])
     for (i = 1; i < OF_MAX; i++)
     {
         if (of_has(p->race->flags, i) && (p->lev >= p->race->flvl[i])) of_on(f, i);
-        if (of_has(p->clazz->flags, i) && (p->lev >= p->clazz->flvl[i]) && !restrict) of_on(f, i);
+        if (of_has(p->clazz->flags, i) && (p->lev >= p->clazz->flvl[i]) && !restricted) of_on(f, i);
     }
 
     /* Ghost */
@@ -393,6 +393,7 @@ struct player *player_get(int id)
 void player_set(int id, struct player *p)
 {
     if ((id > 0) && (id < MAX_PLAYERS)) Players[id] = p;
+    cave_players_changed();
 }
 
 
@@ -447,27 +448,137 @@ void player_safe_name(char *safe, size_t safelen, const char *name)
 }
 
 
-void player_cave_new(struct player *p, int height, int width)
+/*
+ * The known version of a level is kept in a single memory block: the grids, then the row
+ * pointers and the data of the noise and scent maps. The block is simply wiped when changing
+ * to a level with the same dimensions; otherwise it is put aside in a small pool, so that it
+ * can be reused by the next player that needs these dimensions.
+ */
+
+
+/* Number of memory blocks kept aside */
+#define PLAYER_CAVE_POOL    8
+
+
+struct player_cave_block
 {
-    struct loc grid;
+    int height;
+    int width;
+    void *block;
+};
+
+
+static struct player_cave_block player_cave_pool[PLAYER_CAVE_POOL];
+static int player_cave_pool_count;
 
-    if (p->cave->allocated) player_cave_free(p);
+
+/*
+ * Size of the memory block for the given dimensions
+ */
+static size_t player_cave_size(int height, int width)
+{
+    return height * width * sizeof(struct player_square) + height * sizeof(u16b*) +
+        height * sizeof(u32b*) + height * width * sizeof(u32b) + height * width * sizeof(u16b);
+}
+
+
+/*
+ * Point the player cave to the content of a memory block
+ */
+static void player_cave_attach(struct player *p, int height, int width, void *block)
+{
+    byte *cur = block;
+    u32b *scent;
+    u16b *noise;
+    int y;
 
     p->cave->height = height;
     p->cave->width = width;
 
-    p->cave->squares = mem_zalloc(p->cave->height * sizeof(struct player_square*));
-    p->cave->noise.grids = mem_zalloc(p->cave->height * sizeof(u16b*));
-    p->cave->scent.grids = mem_zalloc(p->cave->height * sizeof(u16b*));
-    for (grid.y = 0; grid.y < p->cave->height; grid.y++)
+    p->cave->squares = (struct player_square *)cur;
+    cur += height * width * sizeof(struct player_square);
+    p->cave->noise.grids = (u16b **)cur;
+    cur += height * sizeof(u16b*);
+    p->cave->scent.stamps = (u32b **)cur;
+    cur += height * sizeof(u32b*);
+    scent = (u32b *)cur;
+    cur += height * width * sizeof(u32b);
+    noise = (u16b *)cur;
+
+    for (y = 0; y < height; y++)
     {
-        p->cave->squares[grid.y] = mem_zalloc(p->cave->width * sizeof(struct player_square));
-        for (grid.x = 0; grid.x < p->cave->width; grid.x++)
-            square_p(p, &grid)->info = mem_zalloc(SQUARE_SIZE * sizeof(bitflag));
-        p->cave->noise.grids[grid.y] = mem_zalloc(p->cave->width * sizeof(u16b));
-        p->cave->scent.grids[grid.y] = mem_zalloc(p->cave->width * sizeof(u16b));
+        p->cave->noise.grids[y] = noise + y * width;
+        p->cave->scent.stamps[y] = scent + y * width;
     }
+}
+
+
+/*
+ * Forget all objects and traps, then wipe the content of the player cave in one go
+ */
+static void player_cave_wipe(struct player *p)
+{
+    int n = p->cave->height * p->cave->width;
+    struct loc grid;
+    int i;
+
+    for (i = 0; i < n; i++)
+    {
+        if (!p->cave->squares[i].obj && !p->cave->squares[i].trap) continue;
+
+        i_to_grid(i, p->cave->width, &grid);
+        square_forget_pile(p, &grid);
+        square_forget_trap(p, &grid);
+    }
+
+    memset(p->cave->squares, 0, n * sizeof(struct player_square));
+    p->cave->piles_num = 0;
+    monster_list_forget(p);
+    if (FEAT_NONE)
+    {
+        for (i = 0; i < n; i++) p->cave->squares[i].feat = FEAT_NONE;
+    }
+    memset(p->cave->noise.grids[0], 0, n * sizeof(u16b));
+    memset(p->cave->scent.stamps[0], 0, n * sizeof(u32b));
+    p->cave->scent.clock = 0x10000;
+    p->cave->noise_stamp = 0;
+    loc_init(&p->cave->view_begin, 0, 0);
+    loc_init(&p->cave->view_end, 0, 0);
+}
+
+
+void player_cave_new(struct player *p, int height, int width)
+{
+    void *block = NULL;
+    int i;
+
+    /* Same dimensions: just wipe the current block */
+    if (p->cave->allocated && (p->cave->height == height) && (p->cave->width == width))
+    {
+        player_cave_wipe(p);
+        return;
+    }
+
+    if (p->cave->allocated) player_cave_free(p);
+
+    /* Reuse a block of the right dimensions if possible */
+    for (i = 0; i < player_cave_pool_count; i++)
+    {
+        if ((player_cave_pool[i].height != height) || (player_cave_pool[i].width != width))
+            continue;
+
+        block = player_cave_pool[i].block;
+        player_cave_pool_count--;
+        memcpy(&player_cave_pool[i], &player_cave_pool[player_cave_pool_count],
+            sizeof(struct player_cave_block));
+        break;
+    }
+    if (!block) block = mem_zalloc(player_cave_size(height, width));
+
+    player_cave_attach(p, height, width, block);
     p->cave->allocated = true;
+
+    player_cave_wipe(p);
 }
 
 
@@ -495,6 +606,14 @@ void init_player(struct player *p, int conn, bool old_history, bool no_recall)
         p->scr_info[i] = mem_zalloc((z_info->dungeon_wid + COL_MAP) * sizeof(cave_view_type));
         p->trn_info[i] = mem_zalloc((z_info->dungeon_wid + COL_MAP) * sizeof(cave_view_type));
     }
+    p->scr_dirty = mem_zalloc((z_info->dungeon_hgt + ROW_MAP + 1) * sizeof(bitflag*));
+    for (i = 0; i < z_info->dungeon_hgt + ROW_MAP + 1; i++)
+        p->scr_dirty[i] = mem_zalloc(FLAG_SIZE(z_info->dungeon_wid + COL_MAP) * sizeof(bitflag));
+    p->scr_dirty_rows = mem_zalloc(FLAG_SIZE(z_info->dungeon_hgt + ROW_MAP + 1) * sizeof(bitflag));
+    p->link_dirty = mem_zalloc((z_info->dungeon_hgt + ROW_MAP + 1) * sizeof(bitflag*));
+    for (i = 0; i < z_info->dungeon_hgt + ROW_MAP + 1; i++)
+        p->link_dirty[i] = mem_zalloc(FLAG_SIZE(z_info->dungeon_wid + COL_MAP) * sizeof(bitflag));
+    p->link_dirty_rows = mem_zalloc(FLAG_SIZE(z_info->dungeon_hgt + ROW_MAP + 1) * sizeof(bitflag));
 
     /* Allocate player sub-structs */
     p->upkeep = mem_zalloc(sizeof(struct player_upkeep));
@@ -549,6 +668,8 @@ void init_player(struct player *p, int conn, bool old_history, bool no_recall)
     /* Allocate memory for object and monster lists */
     p->mflag = mem_zalloc(z_info->level_monster_max * MFLAG_SIZE * sizeof(bitflag));
     p->mon_det = mem_zalloc(z_info->level_monster_max * sizeof(byte));
+    p->mon_seen = mem_zalloc(z_info->level_monster_max * sizeof(s16b));
+    p->mon_seen_pos = mem_zalloc(z_info->level_monster_max * sizeof(u16b));
 
     /* Allocate memory for current cave grid info */
     p->cave = mem_zalloc(sizeof(struct player_cave));
@@ -657,6 +778,14 @@ void cleanup_player(struct player *p)
     }
     mem_free(p->scr_info);
     mem_free(p->trn_info);
+    for (i = 0; p->scr_dirty && (i < z_info->dungeon_hgt + ROW_MAP + 1); i++)
+        mem_free(p->scr_dirty[i]);
+    mem_free(p->scr_dirty);
+    mem_free(p->scr_dirty_rows);
+    for (i = 0; p->link_dirty && (i < z_info->dungeon_hgt + ROW_MAP + 1); i++)
+        mem_free(p->link_dirty[i]);
+    mem_free(p->link_dirty);
+    mem_free(p->link_dirty_rows);
     for (i = 0; i < N_HISTORY_FLAGS; i++)
         mem_free(p->hist_flags[i]);
     for (i = 0; p->lore && (i < z_info->r_max); i++)
@@ -671,6 +800,8 @@ void cleanup_player(struct player *p)
     mem_free(p->randart_info);
     mem_free(p->randart_created);
     mem_free(p->obj_aware);
+    for (i = 0; p->note_aware && (i < z_info->k_max); i++)
+        quark_release(p->note_aware[i]);
     mem_free(p->note_aware);
     mem_free(p->obj_tried);
     mem_free(p->kind_ignore);
@@ -691,6 +822,9 @@ void cleanup_player(struct player *p)
     mem_free(p->r_char);
     mem_free(p->mflag);
     mem_free(p->mon_det);
+    mem_free(p->mon_seen);
+    mem_free(p->mon_seen_pos);
+    mem_free(p->play_vis);
     for (i = 0; p->wild_map && (i <= 2 * radius_wild); i++)
         mem_free(p->wild_map[i]);
     mem_free(p->wild_map);
@@ -704,6 +838,7 @@ void cleanup_player(struct player *p)
     if (p->cave)
     {
         player_cave_free(p);
+        mem_free(p->cave->piles);
         mem_free(p->cave);
     }
 
@@ -715,29 +850,53 @@ void cleanup_player(struct player *p)
 
 void player_cave_free(struct player *p)
 {
-    struct loc grid;
+    int n, i;
 
     if (!p->cave->allocated) return;
 
-    for (grid.y = 0; grid.y < p->cave->height; grid.y++)
+    /* Forget all objects and traps */
+    n = p->cave->height * p->cave->width;
+    for (i = 0; i < n; i++)
     {
-        for (grid.x = 0; grid.x < p->cave->width; grid.x++)
-        {
-            mem_free(square_p(p, &grid)->info);
-            square_forget_pile(p, &grid);
-            square_forget_trap(p, &grid);
-        }
-        mem_free(p->cave->squares[grid.y]);
-        mem_free(p->cave->noise.grids[grid.y]);
-        mem_free(p->cave->scent.grids[grid.y]);
+        struct loc grid;
+
+        if (!p->cave->squares[i].obj && !p->cave->squares[i].trap) continue;
+
+        i_to_grid(i, p->cave->width, &grid);
+        square_forget_pile(p, &grid);
+        square_forget_trap(p, &grid);
     }
-    mem_free(p->cave->squares);
-    mem_free(p->cave->noise.grids);
-    mem_free(p->cave->scent.grids);
+
+    /* Put the block aside if possible */
+    if (player_cave_pool_count < PLAYER_CAVE_POOL)
+    {
+        player_cave_pool[player_cave_pool_count].height = p->cave->height;
+        player_cave_pool[player_cave_pool_count].width = p->cave->width;
+        player_cave_pool[player_cave_pool_count].block = p->cave->squares;
+        player_cave_pool_count++;
+    }
+    else
+        mem_free(p->cave->squares);
+
+    p->cave->squares = NULL;
+    p->cave->noise.grids = NULL;
+    p->cave->scent.stamps = NULL;
     p->cave->allocated = false;
 }
 
 
+/*
+ * Free the memory blocks kept aside
+ */
+void player_cave_pool_free(void)
+{
+    int i;
+
+    for (i = 0; i < player_cave_pool_count; i++) mem_free(player_cave_pool[i].block);
+    player_cave_pool_count = 0;
+}
+
+
 /*
  * Clear the flags for each cave grid
  */
@@ -746,50 +905,101 @@ void player_cave_clear(struct player *p, bool full)
     struct loc begin, end;
     struct loc_iterator iter;
 
-    /* Assume no feeling */
-    if (full) p->feeling = -1;
+    /* Full clear: erase everything (including flow information) in one go */
+    if (full)
+    {
+        /* Assume no feeling */
+        p->feeling = -1;
 
-    /* Reset number of feeling squares */
-    if (full) p->cave->feeling_squares = 0;
+        /* Reset number of feeling squares */
+        p->cave->feeling_squares = 0;
 
-    loc_init(&begin, 0, 0);
-    loc_init(&end, p->cave->width, p->cave->height);
-    loc_iterator_first(&iter, &begin, &end);
+        player_cave_wipe(p);
+    }
 
-    /* Clear flags and flow information. */
-    do
+    /* Clear flags */
+    else
     {
-        /* Erase feat */
-        square_forget(p, &iter.cur);
+        loc_init(&begin, 0, 0);
+        loc_init(&end, p->cave->width, p->cave->height);
+        loc_iterator_first(&iter, &begin, &end);
+
+        do
+        {
+            /* Erase feat */
+            square_forget(p, &iter.cur);
 
-        /* Erase object */
-        square_forget_pile(p, &iter.cur);
+            /* Erase object */
+            square_forget_pile(p, &iter.cur);
 
-        /* Erase trap */
-        square_forget_trap(p, &iter.cur);
+            /* Erase trap */
+            square_forget_trap(p, &iter.cur);
 
-        /* Erase flags */
-        if (full)
-            sqinfo_wipe(square_p(p, &iter.cur)->info);
-        else
-        {
             /* Erase flags (no bounds checking) */
             sqinfo_off(square_p(p, &iter.cur)->info, SQUARE_SEEN);
             sqinfo_off(square_p(p, &iter.cur)->info, SQUARE_VIEW);
             sqinfo_off(square_p(p, &iter.cur)->info, SQUARE_DTRAP);
         }
+        while (loc_iterator_next_strict(&iter));
+    }
+
+    /* Memorize the content of owned houses */
+    memorize_houses(p);
+}
 
-        /* Erase flow */
-        if (full)
+
+/*
+ * Scent value of a grid (its age, 0 if there is no scent)
+ *
+ * Scent is stored as the time it was laid, so that aging it doesn't require to visit every
+ * grid. Scent used to be a 16-bit counter, so it vanishes when that counter would overflow.
+ */
+u16b player_scent(struct player *p, struct loc *grid)
+{
+    u32b stamp = p->cave->scent.stamps[grid->y][grid->x];
+    u32b age;
+
+    if (!stamp) return 0;
+
+    age = p->cave->scent.clock - stamp;
+    if (age > 0xFFFF) return 0;
+
+    return (u16b)age;
+}
+
+
+/*
+ * Lay down scent on a grid
+ */
+void player_set_scent(struct player *p, struct loc *grid, u16b scent)
+{
+    p->cave->scent.stamps[grid->y][grid->x] = (scent? p->cave->scent.clock - scent: 0);
+}
+
+
+/*
+ * Age the scent of the whole level by one
+ */
+void player_age_scent(struct player *p)
+{
+    struct loc grid;
+
+    /* Rebase the stamps before the clock wraps around */
+    if (p->cave->scent.clock == 0xFFFFFFFF)
+    {
+        for (grid.y = 0; grid.y < p->cave->height; grid.y++)
         {
-            p->cave->noise.grids[iter.cur.y][iter.cur.x] = 0;
-            p->cave->scent.grids[iter.cur.y][iter.cur.x] = 0;
+            for (grid.x = 0; grid.x < p->cave->width; grid.x++)
+            {
+                u16b scent = player_scent(p, &grid);
+
+                p->cave->scent.stamps[grid.y][grid.x] = (scent? 0x10000 - scent: 0);
+            }
         }
+        p->cave->scent.clock = 0x10000;
     }
-    while (loc_iterator_next_strict(&iter));
 
-    /* Memorize the content of owned houses */
-    memorize_houses(p);
+    p->cave->scent.clock++;
 }
 
 
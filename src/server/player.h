@@ -110,7 +110,11 @@ extern void init_player(struct player *p, int conn, bool old_history, bool no_re
 extern void cleanup_player(struct player *p);
 extern void player_cave_new(struct player *p, int height, int width);
 extern void player_cave_free(struct player *p);
+extern void player_cave_pool_free(void);
 extern void player_cave_clear(struct player *p, bool full);
+extern u16b player_scent(struct player *p, struct loc *grid);
+extern void player_set_scent(struct player *p, struct loc *grid, u16b scent);
+extern void player_age_scent(struct player *p);
 extern bool player_square_in_bounds(struct player *p, struct loc *grid);
 extern bool player_square_in_bounds_fully(struct player *p, struct loc *grid);
 
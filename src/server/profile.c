@@ -0,0 +1,395 @@
+/*
+ * File: profile.c
+ * Purpose: Per-frame phase profiler
+ *
+ * Copyright (c) 2019 MAngband and PWMAngband Developers
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+
+#include "s-angband.h"
+#ifndef WINDOWS
+#include <time.h>
+#endif
+
+
+/*
+ * Each frame, the time spent in the main phases of run_game_loop() is accumulated, then
+ * pushed into a rolling window of the last PROF_WINDOW frames. For each phase we keep a
+ * histogram of that window (log-scaled buckets with four steps per power of two), which
+ * gives the median and 99th percentile without sorting anything.
+ *
+ * The slowest frame since the last reset is kept aside with its full breakdown, along
+ * with the slowest monster pass (and the level it was on) and the slowest display refresh
+ * (and the player it was for).
+ *
+ * A summary is written to the log every PROF_SUMMARY_DELAY seconds, and can be queried
+ * at any time with the "profile" console command.
+ */
+
+
+/* Number of frames in the rolling window */
+#define PROF_WINDOW         1024
+
+/* Number of histogram buckets (covers up to ~16 seconds) */
+#define PROF_BUCKETS        96
+
+/* Delay between two summaries in the log (in seconds) */
+#define PROF_SUMMARY_DELAY  300
+
+
+static const char *prof_phase_name[PROF_MAX] =
+{
+    "frame",
+    "Net_input",
+    "process_monsters",
+    "process_player",
+    "process_objects",
+    "process_world",
+    "process_various",
+    "refresh_stuff",
+    "Net_output",
+    "on_leave_level",
+    "generate_new_level"
+};
+
+
+/*
+ * Breakdown of a frame
+ */
+struct prof_frame
+{
+    u32b phase[PROF_MAX];       /* Time spent in each phase (us) */
+    u32b turn;                  /* Game turn */
+    u32b chunk_time;            /* Slowest monster pass (us) */
+    struct worldpos chunk_wpos; /* Level of the slowest monster pass */
+    u32b player_time;           /* Slowest display refresh (us) */
+    char player_name[NORMAL_WID];   /* Player of the slowest display refresh */
+};
+
+
+/* Current frame */
+static struct prof_frame prof_cur;
+static u64b prof_cur_time[PROF_MAX];
+static u64b prof_frame_start;
+static bool prof_in_frame;
+
+/* Slowest frame since last reset */
+static struct prof_frame prof_worst;
+
+/* Rolling window of frame samples (us) and matching histograms */
+static u32b prof_samples[PROF_MAX][PROF_WINDOW];
+static u32b prof_hist[PROF_MAX][PROF_BUCKETS];
+static u64b prof_sum[PROF_MAX];
+static u32b prof_max[PROF_MAX];
+static int prof_pos;
+static int prof_count;
+
+/* Number of frames over budget since last reset */
+static u32b prof_overruns;
+static u32b prof_frames;
+
+
+/*
+ * Current value of a monotonic clock, in nanoseconds
+ */
+u64b profile_ticks(void)
+{
+#ifdef WINDOWS
+    static LARGE_INTEGER freq;
+    LARGE_INTEGER now;
+
+    if (!freq.QuadPart) QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+
+    return (u64b)((double)now.QuadPart * 1000000000.0 / (double)freq.QuadPart);
+#else
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (u64b)ts.tv_sec * 1000000000 + (u64b)ts.tv_nsec;
+#endif
+}
+
+
+/*
+ * Convert a duration in nanoseconds to microseconds (saturated)
+ */
+static u32b prof_usec(u64b ns)
+{
+    u64b us = ns / 1000;
+
+    if (us > 0xFFFFFFFF) return 0xFFFFFFFF;
+    return (u32b)us;
+}
+
+
+/*
+ * Histogram bucket for a sample: exact below 8us, then four buckets per power of two
+ */
+static int prof_bucket(u32b us)
+{
+    int b = 0, idx;
+
+    if (us < 8) return (int)us;
+
+    while ((us >> b) > 1) b++;
+    idx = 8 + (b - 3) * 4 + (int)((us >> (b - 2)) & 3);
+
+    return MIN(idx, PROF_BUCKETS - 1);
+}
+
+
+/*
+ * Upper bound of a histogram bucket
+ */
+static u32b prof_bucket_limit(int idx)
+{
+    int b, sub;
+
+    if (idx < 8) return (u32b)idx;
+
+    b = 3 + (idx - 8) / 4;
+    sub = (idx - 8) % 4;
+
+    return ((u32b)(4 + sub) << (b - 2)) + ((u32b)1 << (b - 2)) - 1;
+}
+
+
+/*
+ * Value below which the given fraction (in percent) of the samples of a phase lie
+ */
+static u32b prof_percentile(int phase, int percent)
+{
+    u32b wanted = (prof_count * percent + 99) / 100, seen = 0;
+    int i;
+
+    if (!prof_count) return 0;
+
+    for (i = 0; i < PROF_BUCKETS; i++)
+    {
+        seen += prof_hist[phase][i];
+        if (seen >= wanted) return MIN(prof_bucket_limit(i), prof_max[phase]);
+    }
+
+    return prof_max[phase];
+}
+
+
+void profile_frame_begin(void)
+{
+    memset(&prof_cur, 0, sizeof(prof_cur));
+    memset(prof_cur_time, 0, sizeof(prof_cur_time));
+    prof_frame_start = profile_ticks();
+    prof_in_frame = true;
+}
+
+
+/*
+ * Account the time elapsed since "start" to the given phase
+ */
+void profile_add(int phase, u64b start)
+{
+    if (!prof_in_frame) return;
+    prof_cur_time[phase] += profile_ticks() - start;
+}
+
+
+/*
+ * Account a monster pass on a level
+ */
+void profile_add_chunk(struct chunk *c, u64b start)
+{
+    u64b elapsed;
+
+    if (!prof_in_frame) return;
+
+    elapsed = profile_ticks() - start;
+    prof_cur_time[PROF_MONSTERS] += elapsed;
+
+    if (prof_usec(elapsed) >= prof_cur.chunk_time)
+    {
+        prof_cur.chunk_time = prof_usec(elapsed);
+        memcpy(&prof_cur.chunk_wpos, &c->wpos, sizeof(struct worldpos));
+    }
+}
+
+
+/*
+ * Account a display refresh for a player
+ */
+void profile_add_player(struct player *p, u64b start)
+{
+    u64b elapsed;
+
+    if (!prof_in_frame) return;
+
+    elapsed = profile_ticks() - start;
+    prof_cur_time[PROF_REFRESH] += elapsed;
+
+    if (prof_usec(elapsed) >= prof_cur.player_time)
+    {
+        prof_cur.player_time = prof_usec(elapsed);
+        my_strcpy(prof_cur.player_name, p->name, sizeof(prof_cur.player_name));
+    }
+}
+
+
+/*
+ * Log a line of the summary
+ */
+static void prof_plog(void *data, const char *line)
+{
+    plog(line);
+}
+
+
+void profile_frame_end(void)
+{
+    int i;
+
+    if (!prof_in_frame) return;
+    prof_in_frame = false;
+
+    prof_cur_time[PROF_FRAME] = profile_ticks() - prof_frame_start;
+    prof_cur.turn = turn.turn;
+
+    /* Make room in the window */
+    if (prof_count == PROF_WINDOW)
+    {
+        for (i = 0; i < PROF_MAX; i++)
+        {
+            u32b old = prof_samples[i][prof_pos];
+
+            prof_hist[i][prof_bucket(old)]--;
+            prof_sum[i] -= old;
+        }
+    }
+    else
+        prof_count++;
+
+    /* Store the frame */
+    for (i = 0; i < PROF_MAX; i++)
+    {
+        u32b us = prof_usec(prof_cur_time[i]);
+
+        prof_cur.phase[i] = us;
+        prof_samples[i][prof_pos] = us;
+        prof_hist[i][prof_bucket(us)]++;
+        prof_sum[i] += us;
+        if (us > prof_max[i]) prof_max[i] = us;
+    }
+    prof_pos = (prof_pos + 1) % PROF_WINDOW;
+
+    /* Check budget */
+    prof_frames++;
+    if (prof_cur.phase[PROF_FRAME] > (u32b)(1000000 / cfg_fps)) prof_overruns++;
+
+    /* Remember the worst frame */
+    if (prof_cur.phase[PROF_FRAME] >= prof_worst.phase[PROF_FRAME])
+        memcpy(&prof_worst, &prof_cur, sizeof(prof_worst));
+
+    /* Periodic summary */
+    if (!(turn.turn % (PROF_SUMMARY_DELAY * cfg_fps)))
+    {
+        profile_dump(prof_plog, NULL);
+        console_profile_summary();
+    }
+}
+
+
+/*
+ * Forget everything
+ */
+void profile_reset(void)
+{
+    memset(prof_samples, 0, sizeof(prof_samples));
+    memset(prof_hist, 0, sizeof(prof_hist));
+    memset(prof_sum, 0, sizeof(prof_sum));
+    memset(prof_max, 0, sizeof(prof_max));
+    memset(&prof_worst, 0, sizeof(prof_worst));
+    prof_pos = 0;
+    prof_count = 0;
+    prof_overruns = 0;
+    prof_frames = 0;
+}
+
+
+/*
+ * Describe the current statistics, one line at a time
+ */
+void profile_dump(void (*out)(void *, const char *), void *data)
+{
+    char buf[MSG_LEN];
+    int i;
+
+    strnfmt(buf, sizeof(buf), "Frame profile: last %d frames, budget %d us, %lu/%lu overruns",
+        prof_count, 1000000 / cfg_fps, (unsigned long)prof_overruns, (unsigned long)prof_frames);
+    out(data, buf);
+
+    strnfmt(buf, sizeof(buf), "  %-20s %9s %9s %9s %9s", "phase (us)", "avg", "p50", "p99",
+        "max");
+    out(data, buf);
+
+    for (i = 0; i < PROF_MAX; i++)
+    {
+        strnfmt(buf, sizeof(buf), "  %-20s %9lu %9lu %9lu %9lu", prof_phase_name[i],
+            (unsigned long)(prof_count? prof_sum[i] / prof_count: 0),
+            (unsigned long)prof_percentile(i, 50), (unsigned long)prof_percentile(i, 99),
+            (unsigned long)prof_max[i]);
+        out(data, buf);
+    }
+
+    level_cache_describe(buf, sizeof(buf));
+    out(data, buf);
+
+    randart_cache_describe(buf, sizeof(buf));
+    out(data, buf);
+
+    object_pool_describe(buf, sizeof(buf));
+    out(data, buf);
+
+    Net_describe_traffic(buf, sizeof(buf));
+    out(data, buf);
+
+    if (!prof_frames) return;
+
+    strnfmt(buf, sizeof(buf), "Worst frame: %lu us at turn %lu",
+        (unsigned long)prof_worst.phase[PROF_FRAME], (unsigned long)prof_worst.turn);
+    out(data, buf);
+
+    for (i = PROF_FRAME + 1; i < PROF_MAX; i++)
+    {
+        if (!prof_worst.phase[i]) continue;
+
+        strnfmt(buf, sizeof(buf), "  %-20s %9lu", prof_phase_name[i],
+            (unsigned long)prof_worst.phase[i]);
+        out(data, buf);
+    }
+
+    if (prof_worst.chunk_time)
+    {
+        strnfmt(buf, sizeof(buf), "  slowest monster pass: %lu us at (%d, %d) %d ft",
+            (unsigned long)prof_worst.chunk_time, prof_worst.chunk_wpos.grid.x,
+            prof_worst.chunk_wpos.grid.y, prof_worst.chunk_wpos.depth * 50);
+        out(data, buf);
+    }
+
+    if (prof_worst.player_time)
+    {
+        strnfmt(buf, sizeof(buf), "  slowest refresh: %lu us for %s",
+            (unsigned long)prof_worst.player_time, prof_worst.player_name);
+        out(data, buf);
+    }
+}
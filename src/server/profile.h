@@ -0,0 +1,38 @@
+/*
+ * File: profile.h
+ * Purpose: Per-frame phase profiler
+ */
+
+#ifndef INCLUDED_PROFILE_H
+#define INCLUDED_PROFILE_H
+
+/*
+ * Profiled phases of a frame (see run_game_loop())
+ */
+enum
+{
+    PROF_FRAME = 0,
+    PROF_NET_INPUT,
+    PROF_MONSTERS,
+    PROF_PLAYERS,
+    PROF_OBJECTS,
+    PROF_WORLD,
+    PROF_VARIOUS,
+    PROF_REFRESH,
+    PROF_NET_OUTPUT,
+    PROF_LEAVE_LEVEL,
+    PROF_NEW_LEVEL,
+
+    PROF_MAX
+};
+
+extern u64b profile_ticks(void);
+extern void profile_frame_begin(void);
+extern void profile_frame_end(void);
+extern void profile_add(int phase, u64b start);
+extern void profile_add_chunk(struct chunk *c, u64b start);
+extern void profile_add_player(struct player *p, u64b start);
+extern void profile_reset(void);
+extern void profile_dump(void (*out)(void *, const char *), void *data);
+
+#endif /* INCLUDED_PROFILE_H */
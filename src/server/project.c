@@ -428,6 +428,152 @@ byte proj_color(int type)
  */
 
 
+/*
+ * Scratch space for project()
+ *
+ * A projection can trigger another one (for example when a monster explodes), so we keep
+ * a stack of these, which only grows when projections are nested deeper than ever before.
+ */
+struct project_ctx
+{
+    struct loc path_grid[512];  /* Actual grids in the "path" */
+    struct loc blast_grid[256]; /* Coordinates of the affected grids */
+    int distance_to_grid[256];  /* Distance to each of the affected grids */
+    int *dam_at_dist;           /* Precalculated damage values for each distance */
+    bool *drawing;              /* Players on the level who can see the bolt */
+    bool *drawn;                /* Players on the level who can see the explosion */
+    int players_max;            /* Size of the above */
+};
+
+
+static struct project_ctx **project_stack;
+static int project_stack_size;
+static int project_depth;
+
+
+/*
+ * Grid of a blast stencil
+ */
+struct stencil_grid
+{
+    struct loc offset;          /* Offset from the centre of the explosion */
+    int dist;                   /* Distance from the centre of the explosion */
+};
+
+
+/*
+ * Grids within a given distance of the centre of an explosion (excluding the centre),
+ * in the order they used to be scanned (row by row)
+ */
+struct blast_stencil
+{
+    int num_grids;
+    struct stencil_grid *grids;
+};
+
+
+static struct blast_stencil *blast_stencils;
+static int blast_stencil_max;
+
+
+/*
+ * Get the scratch space for a projection on a level with the given number of players
+ */
+static struct project_ctx *project_ctx_get(int num_players)
+{
+    struct project_ctx *ctx;
+
+    /* Allocate a new one if needed */
+    if (project_depth == project_stack_size)
+    {
+        project_stack = mem_realloc(project_stack,
+            (project_stack_size + 1) * sizeof(struct project_ctx *));
+        ctx = mem_zalloc(sizeof(struct project_ctx));
+        ctx->dam_at_dist = mem_zalloc((z_info->max_range + 1) * sizeof(int));
+        project_stack[project_stack_size++] = ctx;
+    }
+    ctx = project_stack[project_depth++];
+
+    /* Make room for the players on the level */
+    if (num_players > ctx->players_max)
+    {
+        ctx->drawing = mem_realloc(ctx->drawing, num_players * sizeof(bool));
+        ctx->drawn = mem_realloc(ctx->drawn, num_players * sizeof(bool));
+        ctx->players_max = num_players;
+    }
+
+    /* Assume the players have seen nothing */
+    if (num_players) memset(ctx->drawing, 0, num_players * sizeof(bool));
+
+    return ctx;
+}
+
+
+/*
+ * Get the stencil of an explosion of the given radius
+ */
+static struct blast_stencil *get_blast_stencil(int rad)
+{
+    struct blast_stencil *stencil;
+    struct loc centre, grid;
+
+    /* Make room */
+    if (rad >= blast_stencil_max)
+    {
+        blast_stencils = mem_realloc(blast_stencils, (rad + 1) * sizeof(struct blast_stencil));
+        memset(&blast_stencils[blast_stencil_max], 0,
+            (rad + 1 - blast_stencil_max) * sizeof(struct blast_stencil));
+        blast_stencil_max = rad + 1;
+    }
+    stencil = &blast_stencils[rad];
+    if (stencil->grids) return stencil;
+
+    /* Build it */
+    stencil->grids = mem_zalloc((2 * rad + 1) * (2 * rad + 1) * sizeof(struct stencil_grid));
+    loc_init(&centre, 0, 0);
+    for (grid.y = -rad; grid.y <= rad; grid.y++)
+    {
+        for (grid.x = -rad; grid.x <= rad; grid.x++)
+        {
+            int dist = distance(&centre, &grid);
+
+            if (loc_is_zero(&grid) || (dist > rad)) continue;
+
+            loc_copy(&stencil->grids[stencil->num_grids].offset, &grid);
+            stencil->grids[stencil->num_grids].dist = dist;
+            stencil->num_grids++;
+        }
+    }
+
+    return stencil;
+}
+
+
+/*
+ * Free the scratch space and the stencils used by project()
+ */
+void project_free(void)
+{
+    int i;
+
+    for (i = 0; i < project_stack_size; i++)
+    {
+        mem_free(project_stack[i]->dam_at_dist);
+        mem_free(project_stack[i]->drawing);
+        mem_free(project_stack[i]->drawn);
+        mem_free(project_stack[i]);
+    }
+    mem_free(project_stack);
+    project_stack = NULL;
+    project_stack_size = 0;
+
+    for (i = 0; i < blast_stencil_max; i++) mem_free(blast_stencils[i].grids);
+    mem_free(blast_stencils);
+    blast_stencils = NULL;
+    blast_stencil_max = 0;
+}
+
+
 static bool stop_project(struct source *who, struct loc *grid, struct chunk *cv, int typ)
 {
     s16b p1_id, p2_id;
@@ -640,29 +786,32 @@ bool project(struct source *origin, int rad, struct chunk *cv, struct loc *finis
     /* Assume the player sees nothing */
     bool notice = false;
 
+    /* Number of players on the level (size of the "drawing" and "drawn" arrays) */
+    int num_players = cave_player_count(cv);
+
+    /* Scratch space (the players on the level are assumed to have seen nothing) */
+    struct project_ctx *ctx = project_ctx_get(num_players);
+
     /* Notify the UI if it can draw this projection */
-    bool drawing[MAX_PLAYERS];
+    bool *drawing = ctx->drawing;
 
     /* Number of grids in the "path" */
     int num_path_grids = 0;
 
     /* Actual grids in the "path" */
-    struct loc path_grid[512];
+    struct loc *path_grid = ctx->path_grid;
 
     /* Number of grids in the "blast area" (including the "beam" path) */
     int num_grids = 0;
 
     /* Coordinates of the affected grids */
-    struct loc blast_grid[256];
+    struct loc *blast_grid = ctx->blast_grid;
 
     /* Distance to each of the affected grids. */
-    int distance_to_grid[256];
+    int *distance_to_grid = ctx->distance_to_grid;
 
     /* Precalculated damage values for each distance. */
-    int *dam_at_dist = malloc((z_info->max_range + 1) * sizeof(*dam_at_dist));
-
-    /* Assume the player has seen nothing */
-    for (i = 0; i < MAX_PLAYERS; ++i) drawing[i] = false;
+    int *dam_at_dist = ctx->dam_at_dist;
 
     /* No projection path - jump to target */
     if (flg & PROJECT_JUMP)
@@ -781,7 +930,7 @@ bool project(struct source *origin, int rad, struct chunk *cv, struct loc *finis
                     loc_copy(&data.grid, &grid);
 
                     /* Tell the UI to display the bolt */
-                    display_bolt(cv, &data, drawing);
+                    display_bolt(cv, &data, drawing, num_players);
                 }
 
                 /* Sometimes stop at non-initial monsters/players */
@@ -812,8 +961,7 @@ bool project(struct source *origin, int rad, struct chunk *cv, struct loc *finis
      */
     if ((rad > 0) && !(flg & PROJECT_BEAM))
     {
-        struct loc begin, end;
-        struct loc_iterator iter;
+        struct blast_stencil *stencil;
 
         /* Pre-calculate some things for arcs. */
         if ((flg & PROJECT_ARC) && (num_path_grids != 0))
@@ -844,24 +992,27 @@ bool project(struct source *origin, int rad, struct chunk *cv, struct loc *finis
             num_grids++;
         }
 
-        loc_init(&begin, centre.x - rad, centre.y - rad);
-        loc_init(&end, centre.x + rad, centre.y + rad);
-        loc_iterator_first(&iter, &begin, &end);
-
-        /* Scan every grid that might possibly be in the blast radius. */
-        do
+        /*
+         * Scan every grid in the blast radius (the center grid has already been stored).
+         * Grids come from a precomputed stencil, so we don't need to check the distance.
+         */
+        stencil = get_blast_stencil(rad);
+        for (j = 0; j < stencil->num_grids; j++)
         {
-            /* PWMAngband: BREATH attacks should also be applied to wraithed players */
-            bool proj_wall = (origin->target && loc_eq(&origin->target->grid, &iter.cur));
-
-            /* Center grid has already been stored. */
-            if (loc_eq(&iter.cur, &centre)) continue;
+            struct loc grid;
+            bool proj_wall;
 
             /* Precaution: Stay within area limit. */
             if (num_grids >= 255) break;
 
+            loc_sum(&grid, &centre, &stencil->grids[j].offset);
+            dist_from_centre = stencil->grids[j].dist;
+
             /* Ignore "illegal" locations */
-            if (!square_in_bounds(cv, &iter.cur)) continue;
+            if (!square_in_bounds(cv, &grid)) continue;
+
+            /* PWMAngband: BREATH attacks should also be applied to wraithed players */
+            proj_wall = (origin->target && loc_eq(&origin->target->grid, &grid));
 
             /*
              * Most explosions are immediately stopped by walls. If
@@ -870,17 +1021,17 @@ bool project(struct source *origin, int rad, struct chunk *cv, struct loc *finis
              * All explosions can affect one layer of terrain which is
              * passable but not projectable.
              */
-            if ((flg & PROJECT_THRU) || square_ispassable(cv, &iter.cur) || proj_wall)
+            if ((flg & PROJECT_THRU) || square_ispassable(cv, &grid) || proj_wall)
             {
                 /* If this is a wall grid, ... */
-                if (!square_isprojectable(cv, &iter.cur))
+                if (!square_isprojectable(cv, &grid))
                 {
                     /* Check neighbors */
                     for (i = 0, k = 0; i < 8; i++)
                     {
                         struct loc ngrid;
 
-                        loc_sum(&ngrid, &iter.cur, &ddgrid_ddd[i]);
+                        loc_sum(&ngrid, &grid, &ddgrid_ddd[i]);
                         if (los(cv, &centre, &ngrid))
                         {
                             k++;
@@ -892,13 +1043,9 @@ bool project(struct source *origin, int rad, struct chunk *cv, struct loc *finis
                     if (!k) continue;
                 }
             }
-            else if (!square_isprojectable(cv, &iter.cur))
+            else if (!square_isprojectable(cv, &grid))
                 continue;
-            /*if (!los(cv, &centre, &iter.cur)) continue;*/
-
-            /* Must be within maximum distance. */
-            dist_from_centre = distance(&centre, &iter.cur);
-            if (dist_from_centre > rad) continue;
+            /*if (!los(cv, &centre, &grid)) continue;*/
 
             /* Do we need to consider a restricted angle? */
             if (flg & PROJECT_ARC)
@@ -907,8 +1054,8 @@ bool project(struct source *origin, int rad, struct chunk *cv, struct loc *finis
                 int n2y, n2x, tmp, rotate, diff;
 
                 /* Reorient current grid for table access. */
-                n2y = iter.cur.y - start.y + 20;
-                n2x = iter.cur.x - start.x + 20;
+                n2y = grid.y - start.y + 20;
+                n2x = grid.x - start.x + 20;
 
                 /*
                  * Find the angular difference (/2) between
@@ -925,26 +1072,25 @@ bool project(struct source *origin, int rad, struct chunk *cv, struct loc *finis
                  */
                 if (diff < (degrees_of_arc + 6) / 4)
                 {
-                    if (los(cv, &centre, &iter.cur))
+                    if (los(cv, &centre, &grid))
                     {
-                        loc_copy(&blast_grid[num_grids], &iter.cur);
+                        loc_copy(&blast_grid[num_grids], &grid);
                         distance_to_grid[num_grids] = dist_from_centre;
-                        sqinfo_on(square(cv, &iter.cur)->info, SQUARE_PROJECT);
+                        sqinfo_on(square(cv, &grid)->info, SQUARE_PROJECT);
                         num_grids++;
                     }
                 }
             }
 
             /* Accept all grids in LOS */
-            else if (los(cv, &centre, &iter.cur))
+            else if (los(cv, &centre, &grid))
             {
-                loc_copy(&blast_grid[num_grids], &iter.cur);
+                loc_copy(&blast_grid[num_grids], &grid);
                 distance_to_grid[num_grids] = dist_from_centre;
-                sqinfo_on(square(cv, &iter.cur)->info, SQUARE_PROJECT);
+                sqinfo_on(square(cv, &grid)->info, SQUARE_PROJECT);
                 num_grids++;
             }
         }
-        while (loc_iterator_next(&iter));
     }
 
     /* Calculate and store the actual damage at each distance. */
@@ -1013,16 +1159,17 @@ bool project(struct source *origin, int rad, struct chunk *cv, struct loc *finis
         data.blast_grid = blast_grid;
 
         /* Tell the UI to display the blast */
-        display_explosion(cv, &data, drawing, ((flg & PROJECT_ARC)? true: false));
+        display_explosion(cv, &data, drawing, ctx->drawn, num_players,
+            ((flg & PROJECT_ARC)? true: false));
     }
 
-    /* Hack -- count how many projections we have seen */
-    for (j = 1; j <= NumPlayers; j++)
+    /* Hack -- count how many projections we have seen (players may have left the level) */
+    num_players = MIN(num_players, cave_player_count(cv));
+    for (j = 0; j < num_players; j++)
     {
-        struct player *p = player_get(j);
+        struct player *p = cave_player(cv, j);
 
         /* Skip irrelevant players */
-        if (!wpos_eq(&p->wpos, &cv->wpos)) continue;
         if (p->timed[TMD_BLIND]) continue;
 
         /* Add one to the count */
@@ -1168,7 +1315,8 @@ bool project(struct source *origin, int rad, struct chunk *cv, struct loc *finis
         sqinfo_off(square(cv, &blast_grid[i])->info, SQUARE_PROJECT);
     }
 
-    free(dam_at_dist);
+    /* Release the scratch space */
+    project_depth--;
 
     /* Return "something was noticed" */
     return (notice);
@@ -87,6 +87,7 @@ extern byte proj_color(int type);
 extern void origin_get_loc(struct loc *ploc, struct source *origin);
 extern bool project(struct source *origin, int rad, struct chunk *cv, struct loc *finish, int dam,
     int typ, int flg, int degrees_of_arc, byte diameter_of_source, const char *what);
+extern void project_free(void);
 
 /* project-feat.c */
 extern bool project_f(struct source *origin, int r, struct chunk *c, struct loc *grid, int dam,
@@ -21,6 +21,7 @@
  * Include the high-level includes
  */
 #include "alloc.h"
+#include "bench.h"
 #include "cave.h"
 #include "channel.h"
 #include "cmds.h"
@@ -54,6 +55,7 @@
 #include "mon-summon.h"
 #include "mon-timed.h"
 #include "mon-util.h"
+#include "net-queue.h"
 #include "netserver.h"
 #include "object.h"
 #include "obj-chest.h"
@@ -88,6 +90,7 @@
 #include "player-ui.h"
 #include "player-util.h"
 #include "prefs-ui.h"
+#include "profile.h"
 #include "project.h"
 #include "savefile.h"
 #include "sched-win.h"
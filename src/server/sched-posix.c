@@ -0,0 +1,526 @@
+/*
+ * File: sched-posix.c
+ * Purpose: POSIX (Linux epoll) port of sched.c
+ *
+ * Copyright (c) 2019 MAngband and PWMAngband Developers
+ *
+ * This work is free software; you can redistribute it and/or modify it
+ * under the terms of either:
+ *
+ * a) the GNU General Public License as published by the Free Software
+ *    Foundation, version 2, or
+ *
+ * b) the "Angband licence":
+ *    This software may be copied and distributed for educational, research,
+ *    and not for profit purposes provided that this copyright and statement
+ *    are included in all such copies.  Other copyrights may also apply.
+ */
+
+
+#include "s-angband.h"
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+
+/*
+ * Unlike the Windows port, which polls every input with select() and a short timeout,
+ * this version sleeps in epoll_wait() until either a socket is readable or the frame
+ * timer (a timerfd registered in the same epoll set) fires. The cost of a wakeup is
+ * then proportional to the number of ready descriptors, not to the highest one.
+ *
+ * A socket with an input handler can also get an output handler, called when the socket
+ * becomes writable again (this is used to drain the output queues of the connections).
+ */
+
+
+/* Maximum number of events fetched by a single epoll_wait() call */
+#define MAX_EPOLL_EVENTS    64
+
+
+static long timer_ticks;
+static long frame_count;
+static long timer_freq; /* frequency (Hz) at which timer ticks. */
+static void (*timer_handler)(void);
+static time_t current_time;
+static int ticks_till_second;
+static int epoll_fd = -1;
+static int timer_fd = -1;
+
+
+/*
+ * Create the epoll set (only once)
+ */
+static void setup_epoll(void)
+{
+    if (epoll_fd != -1) return;
+
+    epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd == -1)
+    {
+        plog_fmt("Could not create epoll set: %d", errno);
+        exit(1);
+    }
+}
+
+
+/*
+ * Disarm the frame timer
+ */
+static void stop_timer(void)
+{
+    struct itimerspec its;
+
+    memset(&its, 0, sizeof(its));
+    timerfd_settime(timer_fd, 0, &its, NULL);
+}
+
+
+/*
+ * Start (or restart) the frame timer
+ */
+static void setup_timer(void)
+{
+    struct itimerspec its;
+    long delay;
+
+    setup_epoll();
+
+    /* Create the timer and hook it into the epoll set the first time around */
+    if (timer_fd == -1)
+    {
+        struct epoll_event ev;
+
+        timer_fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (timer_fd == -1)
+        {
+            plog("Could not create timer");
+            exit(1);
+        }
+
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.fd = timer_fd;
+        if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, timer_fd, &ev) == -1)
+        {
+            plog("Could not register timer");
+            exit(1);
+        }
+    }
+
+    /* Nanoseconds per frame */
+    delay = 1000000000L / timer_freq;
+    plog_fmt("Timer delay %ld us", delay / 1000);
+
+    memset(&its, 0, sizeof(its));
+    its.it_value.tv_sec = delay / 1000000000L;
+    its.it_value.tv_nsec = delay % 1000000000L;
+    its.it_interval = its.it_value;
+
+    frame_count = 0;
+    timer_ticks = 0;
+    ticks_till_second = timer_freq;
+    if (timerfd_settime(timer_fd, 0, &its, NULL) == -1)
+    {
+        plog("Could not start timer");
+        exit(1);
+    }
+}
+
+
+/*
+ * Collect elapsed timer expirations
+ */
+static void timer_callback(void)
+{
+    u64b expirations;
+
+    if (read(timer_fd, &expirations, sizeof(expirations)) == sizeof(expirations))
+        timer_ticks += (long)expirations;
+}
+
+
+/*
+* Configure timer tick callback.  freq is FPS from the .cfg file
+*/
+void install_timer_tick(void (*func)(void), int freq)
+{
+    timer_handler = func;
+    timer_freq = freq;
+    setup_timer();
+}
+
+
+struct to_handler
+{
+    struct to_handler *next;
+    time_t when;
+    void (*func)(void *);
+    void *arg;
+};
+
+
+static struct to_handler *to_busy_list = NULL;
+static struct to_handler *to_free_list = NULL;
+static int to_min_free = 3;
+static int to_max_free = 5;
+static int to_cur_free = 0;
+
+
+static void to_fill(void)
+{
+    if (to_cur_free >= to_min_free) return;
+
+    do
+    {
+        struct to_handler *top = (struct to_handler *)mem_alloc(sizeof(struct to_handler));
+
+        if (!top) break;
+        top->next = to_free_list;
+        to_free_list = top;
+        to_cur_free++;
+    }
+    while (to_cur_free < to_max_free);
+}
+
+
+static struct to_handler *to_alloc(void)
+{
+    struct to_handler *top;
+
+    to_fill();
+    if (!to_free_list)
+    {
+        plog("Not enough memory for timeouts");
+        exit(1);
+    }
+
+    top = to_free_list;
+    to_free_list = top->next;
+    to_cur_free--;
+    top->next = 0;
+
+    return top;
+}
+
+
+static void to_free(struct to_handler *top)
+{
+    if (to_cur_free < to_max_free)
+    {
+        top->next = to_free_list;
+        to_free_list = top;
+        to_cur_free++;
+    }
+    else mem_free(top);
+}
+
+
+/*
+* Configure timout callback.
+*/
+void install_timeout(void (*func)(void *), int offset, void *arg)
+{
+    struct to_handler *top = to_alloc();
+
+    top->func = func;
+    top->when = current_time + offset;
+    top->arg = arg;
+    if (!to_busy_list || (to_busy_list->when >= top->when))
+    {
+        top->next = NULL;
+        to_busy_list = top;
+    }
+    else
+    {
+        struct to_handler *prev = to_busy_list;
+        struct to_handler *lp = prev->next;
+
+        while (lp && lp->when < top->when)
+        {
+            prev = lp;
+            lp = lp->next;
+        }
+        top->next = lp;
+        prev->next = top;
+    }
+}
+
+
+void remove_timeout(void (*func)(void *), void *arg)
+{
+    struct to_handler *prev = 0;
+    struct to_handler *lp = to_busy_list;
+
+    while (lp)
+    {
+        if ((lp->func == func) && (lp->arg == arg))
+        {
+            struct to_handler *top = lp;
+
+            lp = lp->next;
+            if (prev) prev->next = lp;
+            else to_busy_list = lp;
+            to_free(top);
+        }
+        else
+        {
+            prev = lp;
+            lp = lp->next;
+        }
+    }
+}
+
+
+static void timeout_chime(void)
+{
+    while (to_busy_list && (to_busy_list->when <= current_time))
+    {
+        struct to_handler *top = to_busy_list;
+        void (*func)(void *) = top->func;
+        void *arg = top->arg;
+
+        to_busy_list = top->next;
+        to_free(top);
+        (*func)(arg);
+    }
+}
+
+
+struct io_handler
+{
+    void (*func)(int, int);
+    int arg;
+};
+
+
+static struct io_handler *input_handlers = NULL;
+static struct io_handler *output_handlers = NULL;
+static int biggest_fd = -1;
+
+
+void install_input(void (*func)(int, int), int fd, int arg)
+{
+    struct epoll_event ev;
+
+    setup_epoll();
+    if (fd < 0)
+    {
+        plog_fmt("install illegal input handler fd %d", fd);
+        exit(1);
+    }
+    if ((fd <= biggest_fd) && input_handlers[fd].func)
+    {
+        plog_fmt("input handler %d busy", fd);
+        exit(1);
+    }
+    if (fd > biggest_fd)
+    {
+        input_handlers = mem_realloc(input_handlers, sizeof(struct io_handler) * (fd + 1));
+        output_handlers = mem_realloc(output_handlers, sizeof(struct io_handler) * (fd + 1));
+        if ((input_handlers == NULL) || (output_handlers == NULL))
+        {
+            plog_fmt("input handler %d realloc failed", fd);
+            exit(1);
+        }
+        memset(&input_handlers[biggest_fd + 1], 0,
+            sizeof(struct io_handler) * (fd - biggest_fd));
+        memset(&output_handlers[biggest_fd + 1], 0,
+            sizeof(struct io_handler) * (fd - biggest_fd));
+        biggest_fd = fd;
+    }
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &ev) == -1)
+    {
+        plog_fmt("input handler %d epoll_ctl failed: %d", fd, errno);
+        exit(1);
+    }
+
+    input_handlers[fd].func = func;
+    input_handlers[fd].arg = arg;
+}
+
+
+void remove_input(int fd)
+{
+    if (fd < 0)
+    {
+        plog_fmt("remove illegal input handler fd %d", fd);
+        exit(1);
+    }
+    if ((fd <= biggest_fd) && input_handlers[fd].func)
+    {
+        input_handlers[fd].func = 0;
+        output_handlers[fd].func = 0;
+
+        /* The socket may already be closed, in which case the kernel dropped it for us */
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+    }
+}
+
+
+/*
+ * Watch a socket (which must have an input handler) until it becomes writable
+ */
+void install_output(void (*func)(int, int), int fd, int arg)
+{
+    struct epoll_event ev;
+
+    if ((fd < 0) || (fd > biggest_fd) || !input_handlers[fd].func)
+    {
+        plog_fmt("install illegal output handler fd %d", fd);
+        exit(1);
+    }
+    if (output_handlers[fd].func)
+    {
+        plog_fmt("output handler %d busy", fd);
+        exit(1);
+    }
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLOUT;
+    ev.data.fd = fd;
+    if (epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &ev) == -1)
+    {
+        plog_fmt("output handler %d epoll_ctl failed: %d", fd, errno);
+        exit(1);
+    }
+
+    output_handlers[fd].func = func;
+    output_handlers[fd].arg = arg;
+}
+
+
+void remove_output(int fd)
+{
+    struct epoll_event ev;
+
+    if ((fd < 0) || (fd > biggest_fd) || !output_handlers[fd].func) return;
+
+    output_handlers[fd].func = 0;
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_MOD, fd, &ev);
+}
+
+
+static void null_timer_handler(void)
+{
+}
+
+
+/*
+ * MAngband Main Game Loop
+ * Here we are endlessly looping, handling socket IO and calling dungeon()
+ * on each tick of our frame timer (FPS)
+ */
+void sched(void)
+{
+    int io_todo = 3;
+    struct epoll_event events[MAX_EPOLL_EVENTS];
+
+    setup_epoll();
+
+    while (true)
+    {
+        if ((io_todo == 0) && (frame_count < timer_ticks))
+        {
+            io_todo = 3;
+
+            (*timer_handler)();
+
+            do
+            {
+                ++frame_count;
+                if (--ticks_till_second <= 0)
+                {
+                    ticks_till_second += timer_freq;
+                    current_time++;
+                    timeout_chime();
+                }
+            }
+            while (frame_count < timer_ticks);
+        }
+        else
+        {
+            int n, i, io_count = 0;
+
+            /*
+             * Only block when no frame is due: the frame timer is part of the epoll set,
+             * so we'll be woken up in time for the next tick anyway.
+             */
+            n = epoll_wait(epoll_fd, events, MAX_EPOLL_EVENTS,
+                ((frame_count < timer_ticks)? 0: -1));
+            if (n < 0)
+            {
+                /* Don't report fake socket errors, or when already quitting */
+                if ((timer_handler != null_timer_handler) && (errno != EINTR))
+                    quit_fmt("sched epoll error: %d", errno);
+                io_todo = 0;
+                continue;
+            }
+
+            for (i = 0; i < n; i++)
+            {
+                int fd = events[i].data.fd;
+
+                if (fd == timer_fd)
+                {
+                    timer_callback();
+                    continue;
+                }
+
+                /*
+                 * The handlers may have been removed by a previous callback in this batch
+                 * (this happens when a connection is destroyed)
+                 */
+                if (fd > biggest_fd) continue;
+
+                if ((events[i].events & ~EPOLLOUT) && input_handlers[fd].func)
+                {
+                    (*input_handlers[fd].func)(fd, input_handlers[fd].arg);
+                    io_count++;
+                }
+
+                if ((events[i].events & EPOLLOUT) && output_handlers[fd].func)
+                    (*output_handlers[fd].func)(fd, output_handlers[fd].arg);
+            }
+
+            /* Nothing but the timer: time to run a frame */
+            if (io_count == 0) io_todo = 0;
+            else if (io_todo > 0) io_todo--;
+        }
+    }
+}
+
+
+void free_input()
+{
+    mem_free(input_handlers);
+    input_handlers = NULL;
+    mem_free(output_handlers);
+    output_handlers = NULL;
+    biggest_fd = -1;
+    if (timer_fd != -1)
+    {
+        close(timer_fd);
+        timer_fd = -1;
+    }
+    if (epoll_fd != -1)
+    {
+        close(epoll_fd);
+        epoll_fd = -1;
+    }
+}
+
+
+void remove_timer_tick(void)
+{
+    if (timer_fd != -1) stop_timer();
+    timer_handler = null_timer_handler;
+}
@@ -251,8 +251,10 @@ struct io_handler
 
 
 static struct io_handler *input_handlers = NULL;
+static struct io_handler *output_handlers = NULL;
 static int biggest_fd = -1;
 static fd_set input_mask;
+static fd_set output_mask;
 static int input_mask_cleared = false;
 static int max_fd;
 
@@ -261,6 +263,7 @@ static int max_fd;
 static void clear_mask(void)
 {
     FD_ZERO(&input_mask);
+    FD_ZERO(&output_mask);
 }
 
 
@@ -287,9 +290,11 @@ void install_input(void (*func)(int, int), int fd, int arg)
         {
             input_handlers = mem_realloc(input_handlers,
                 sizeof(struct io_handler) * (fd + 1));
+            output_handlers = mem_realloc(output_handlers,
+                sizeof(struct io_handler) * (fd + 1));
             biggest_fd = fd;
         }
-        if (input_handlers == NULL)
+        if ((input_handlers == NULL) || (output_handlers == NULL))
         {
             plog_fmt("input handler %d realloc failed", fd);
             exit(1);
@@ -309,6 +314,7 @@ void remove_input(int fd)
         plog_fmt("remove illegal input handler fd %d", fd);
         exit(1);
     }
+    remove_output(fd);
     if (FD_ISSET(fd, &input_mask))
     {
         input_handlers[fd].func = 0;
@@ -331,6 +337,36 @@ void remove_input(int fd)
 }
 
 
+/*
+ * Watch a socket (which must have an input handler) until it becomes writable
+ */
+void install_output(void (*func)(int, int), int fd, int arg)
+{
+    if ((fd < 0) || !FD_ISSET(fd, &input_mask))
+    {
+        plog_fmt("install illegal output handler fd %d", fd);
+        exit(1);
+    }
+    if (FD_ISSET(fd, &output_mask))
+    {
+        plog_fmt("output handler %d busy", fd);
+        exit(1);
+    }
+    output_handlers[fd].func = func;
+    output_handlers[fd].arg = arg;
+    FD_SET((SOCKET)fd, &output_mask);
+}
+
+
+void remove_output(int fd)
+{
+    if ((fd < 0) || !FD_ISSET(fd, &output_mask)) return;
+
+    output_handlers[fd].func = 0;
+    FD_CLR((SOCKET)fd, &output_mask);
+}
+
+
 static void null_timer_handler(void)
 {
 }
@@ -346,6 +382,7 @@ void sched(void)
     int io_done = 0, io_todo = 3;
     struct timeval tv;
     fd_set readmask = input_mask;
+    fd_set writemask = output_mask;
 
     while (true)
     {
@@ -380,8 +417,9 @@ void sched(void)
              * the "timeout_chime" function call (which happens when a player dies).
              */
             readmask = input_mask;
+            writemask = output_mask;
 
-            n = select(max_fd, &readmask, NULL, NULL, &tv);
+            n = select(max_fd, &readmask, &writemask, NULL, &tv);
             if (n < 0)
             {
                 /* Don't report fake socket errors, or when already quitting */
@@ -400,6 +438,13 @@ void sched(void)
 
                 for (i = max_fd; i >= 0; i--)
                 {
+                    /* Drain the output queues (the handler may have been removed meanwhile) */
+                    if (FD_ISSET(i, &writemask) && FD_ISSET(i, &output_mask))
+                    {
+                        (*output_handlers[i].func)(i, output_handlers[i].arg);
+                        if (--n == 0) break;
+                    }
+
                     if (FD_ISSET(i, &readmask))
                     {
                         (*input_handlers[i].func)(i, input_handlers[i].arg);
@@ -418,6 +463,7 @@ void sched(void)
 void free_input()
 {
     mem_free(input_handlers);
+    mem_free(output_handlers);
 }
 
 
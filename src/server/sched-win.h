@@ -9,6 +9,8 @@
 extern void install_timer_tick(void (*func)(void), int freq);
 extern void install_input(void (*func)(int, int), int fd, int arg);
 extern void remove_input(int fd);
+extern void install_output(void (*func)(int, int), int fd, int arg);
+extern void remove_output(int fd);
 extern void sched(void);
 extern void free_input(void);
 extern void remove_timer_tick(void);
@@ -1386,7 +1386,7 @@ static bool store_create_random(struct store *store)
 
         /* Hack -- set fake owner and level requirement */
         obj->owner = -1;
-        obj->level_req = max(min(obj->kind->level / 2, 50), 1);
+        obj->level_req = MAX(MIN(obj->kind->level / 2, 50), 1);
 
         /* Attempt to carry the object */
         if (!store_carry(NULL, store, obj))
@@ -1419,7 +1419,7 @@ static struct object *store_create_item(struct store *store, struct object_kind
 
     /* Hack -- set fake owner and level requirement */
     obj->owner = -1;
-    obj->level_req = max(min(obj->kind->level / 2, 50), 1);
+    obj->level_req = MAX(MIN(obj->kind->level / 2, 50), 1);
 
     /* Attempt to carry the object */
     return store_carry(NULL, store, obj);
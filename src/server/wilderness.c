@@ -1226,6 +1226,9 @@ void free_wild_info(void)
     int i;
     struct loc grid;
 
+    /* Deallocate the levels that are not in use anymore */
+    level_cache_free();
+
     for (grid.y = radius_wild; grid.y >= 0 - radius_wild; grid.y--)
     {
         for (grid.x = 0 - radius_wild; grid.x <= radius_wild; grid.x++)
@@ -1235,18 +1238,21 @@ void free_wild_info(void)
             /* Caves */
             for (i = 0; i <= w_ptr->max_depth - w_ptr->min_depth; i++)
             {
-                if (!w_ptr->chunk_list[i]) continue;
+                struct chunk *c = w_ptr->chunk_list[i];
+
+                if (!c) continue;
 
                 /* Deallocate the level */
-                wipe_mon_list(w_ptr->chunk_list[i]);
-                cave_free(w_ptr->chunk_list[i]);
-                w_ptr->chunk_list[i] = NULL;
+                chunk_list_remove(c);
+                wipe_mon_list(c);
+                cave_free(c);
             }
 
             mem_free(w_ptr->chunk_list);
             mem_free(w_ptr->players_on_depth);
         }
     }
+    chunk_list_free();
 
     for (i = 0; i <= 2 * radius_wild; i++)
         mem_free(wt_info[i]);
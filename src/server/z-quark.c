@@ -23,46 +23,246 @@
 #include "s-angband.h"
 
 
-static char **quarks;
+/*
+ * Quarks are found from their string with an open-addressing hash index (linear probing),
+ * kept at most half full. The strings of permanent quarks are packed in blocks of memory.
+ *
+ * Quarks made by quark_add() are permanent, since their numbers are copied freely (objects
+ * and their copies). Quarks made by quark_add_ref() are reference-counted instead: once their
+ * last reference is released, their string is freed and their number can be reused. Adding
+ * the same string with quark_add() makes such a quark permanent.
+ */
+
+
+#define QUARKS_INIT 16
+#define QUARK_BLOCK_SIZE 4096
+
+
+struct quark
+{
+    char *str;      /* String (NULL if the quark was reclaimed) */
+    u32b hash;      /* Hash of the string */
+    u32b refs;      /* Number of counted references */
+    bool pinned;    /* Quark is permanent */
+    bool own;       /* String is allocated on its own (not in a block) */
+};
+
+
+struct quark_block
+{
+    struct quark_block *next;
+    char *data;
+    size_t size;
+    size_t used;
+};
+
+
+static struct quark *quarks;
 static size_t nr_quarks = 1;
 static size_t alloc_quarks = 0;
 
+/* Reclaimed quark numbers */
+static quark_t *free_quarks;
+static size_t nr_free_quarks = 0;
+static size_t alloc_free_quarks = 0;
 
-#define QUARKS_INIT 16
+/* Hash index */
+static quark_t *quark_index;
+static size_t index_size = 0;
 
+/* String storage */
+static struct quark_block *quark_blocks;
 
-quark_t quark_add(const char *str)
+
+/*
+ * Copy a string into the current block
+ */
+static char *quark_block_make(const char *str)
 {
+    size_t len = strlen(str) + 1;
+    char *res;
+
+    if (!quark_blocks || (quark_blocks->used + len > quark_blocks->size))
+    {
+        struct quark_block *block = mem_zalloc(sizeof(*block));
+
+        block->size = MAX(len, QUARK_BLOCK_SIZE);
+        block->data = mem_alloc(block->size);
+        block->next = quark_blocks;
+        quark_blocks = block;
+    }
+
+    res = quark_blocks->data + quark_blocks->used;
+    memcpy(res, str, len);
+    quark_blocks->used += len;
+
+    return res;
+}
+
+
+/*
+ * Find the quark for a string, or the slot of the index where it should go
+ */
+static quark_t quark_find(const char *str, u32b hash, size_t *slot)
+{
+    size_t mask = index_size - 1;
+    size_t i = hash & mask;
+
+    while (quark_index[i])
+    {
+        quark_t q = quark_index[i];
+
+        if ((quarks[q].hash == hash) && streq(quarks[q].str, str)) return q;
+        i = (i + 1) & mask;
+    }
+
+    *slot = i;
+    return 0;
+}
+
+
+/*
+ * Double the size of the index (or create it)
+ */
+static void quark_index_grow(void)
+{
+    size_t mask;
     quark_t q;
 
+    mem_free(quark_index);
+    index_size = (index_size? index_size * 2: QUARKS_INIT * 2);
+    quark_index = mem_zalloc(index_size * sizeof(quark_t));
+    mask = index_size - 1;
+
     for (q = 1; q < nr_quarks; q++)
     {
-        if (!strcmp(quarks[q], str)) return q;
+        size_t i;
+
+        if (!quarks[q].str) continue;
+
+        i = quarks[q].hash & mask;
+        while (quark_index[i]) i = (i + 1) & mask;
+        quark_index[i] = q;
+    }
+}
+
+
+/*
+ * Remove a quark from the index, moving back the entries that follow it if needed
+ */
+static void quark_index_remove(quark_t q)
+{
+    size_t mask = index_size - 1;
+    size_t i = quarks[q].hash & mask, j;
+
+    while (quark_index[i] != q) i = (i + 1) & mask;
+
+    for (j = (i + 1) & mask; quark_index[j]; j = (j + 1) & mask)
+    {
+        size_t k = quarks[quark_index[j]].hash & mask;
+
+        /* Leave the entry alone if its home slot is between the hole and itself */
+        if ((i <= j)? ((i < k) && (k <= j)): ((i < k) || (k <= j))) continue;
+
+        quark_index[i] = quark_index[j];
+        i = j;
     }
 
-    if (nr_quarks == alloc_quarks)
+    quark_index[i] = 0;
+}
+
+
+/*
+ * Find or create the quark for a string
+ */
+static quark_t quark_get(const char *str, bool pinned)
+{
+    u32b hash = djb2_hash(str);
+    size_t slot;
+    quark_t q;
+
+    /* Keep the index at most half full */
+    if ((nr_quarks - nr_free_quarks) * 2 > index_size) quark_index_grow();
+
+    q = quark_find(str, hash, &slot);
+    if (q)
     {
-        alloc_quarks *= 2;
-        quarks = mem_realloc(quarks, alloc_quarks * sizeof(char *));
+        if (pinned) quarks[q].pinned = true;
+        return q;
     }
-    
-    q = nr_quarks++;
-    quarks[q] = string_make(str);
+
+    /* Reuse a reclaimed number if possible */
+    if (nr_free_quarks) q = free_quarks[--nr_free_quarks];
+    else
+    {
+        if (nr_quarks == alloc_quarks)
+        {
+            alloc_quarks *= 2;
+            quarks = mem_realloc(quarks, alloc_quarks * sizeof(struct quark));
+        }
+        q = nr_quarks++;
+    }
+
+    quarks[q].own = !pinned;
+    quarks[q].str = (pinned? quark_block_make(str): string_make(str));
+    quarks[q].hash = hash;
+    quarks[q].refs = 0;
+    quarks[q].pinned = pinned;
+    quark_index[slot] = q;
 
     return q;
 }
 
 
+quark_t quark_add(const char *str)
+{
+    return quark_get(str, true);
+}
+
+
+quark_t quark_add_ref(const char *str)
+{
+    quark_t q = quark_get(str, false);
+
+    quarks[q].refs++;
+    return q;
+}
+
+
+void quark_release(quark_t q)
+{
+    /* The table may already be gone on shutdown */
+    if (!quarks || !q || (q >= nr_quarks) || !quarks[q].str) return;
+
+    if (quarks[q].refs) quarks[q].refs--;
+    if (quarks[q].refs || quarks[q].pinned) return;
+
+    /* Reclaim the quark */
+    quark_index_remove(q);
+    string_free(quarks[q].str);
+    quarks[q].str = NULL;
+    quarks[q].own = false;
+
+    if (nr_free_quarks == alloc_free_quarks)
+    {
+        alloc_free_quarks = (alloc_free_quarks? alloc_free_quarks * 2: QUARKS_INIT);
+        free_quarks = mem_realloc(free_quarks, alloc_free_quarks * sizeof(quark_t));
+    }
+    free_quarks[nr_free_quarks++] = q;
+}
+
+
 const char *quark_str(quark_t q)
 {
-    return ((q >= nr_quarks)? NULL: quarks[q]);
+    return ((q >= nr_quarks)? NULL: quarks[q].str);
 }
 
 
 static void quarks_init(void)
 {
     alloc_quarks = QUARKS_INIT;
-    quarks = mem_zalloc(alloc_quarks * sizeof(char*));
+    quarks = mem_zalloc(alloc_quarks * sizeof(struct quark));
+    quark_index_grow();
 }
 
 
@@ -70,9 +270,26 @@ static void quarks_free(void)
 {
     size_t i;
 
-    for (i = 1; i < nr_quarks; i++) string_free(quarks[i]);
+    for (i = 1; i < nr_quarks; i++)
+    {
+        if (quarks[i].own) string_free(quarks[i].str);
+    }
+
+    while (quark_blocks)
+    {
+        struct quark_block *next = quark_blocks->next;
+
+        mem_free(quark_blocks->data);
+        mem_free(quark_blocks);
+        quark_blocks = next;
+    }
 
     mem_free(quarks);
+    quarks = NULL;
+    mem_free(quark_index);
+    quark_index = NULL;
+    mem_free(free_quarks);
+    free_quarks = NULL;
 }
 
 
@@ -12,6 +12,16 @@
  */
 extern quark_t quark_add(const char *str);
 
+/*
+ * Return a reference-counted quark for the string 'str'
+ */
+extern quark_t quark_add_ref(const char *str);
+
+/*
+ * Release a reference to a quark obtained from quark_add_ref()
+ */
+extern void quark_release(quark_t q);
+
 /*
  * Return the string corresponding to the quark
  */